@@ -0,0 +1,105 @@
+///
+/// @file  datetime_arrow.cpp
+///
+/// @brief Implementation file for the (non-template) parts of header
+///        datetime_arrow.hpp, i.e. building and releasing the exported
+///        Arrow C Data Interface structures.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#include "datetime_arrow.hpp"
+#include <cstring>
+#include <string>
+
+/// Private data of an exported ArrowArray.
+struct arrow_array_data
+{
+  const void*   buffers[2]; ///< validity (none) and values buffers
+  std::int64_t* owned;      ///< the values, if owned by the export
+};
+
+/// Private data of an exported ArrowSchema.
+struct arrow_schema_data
+{
+  std::string format;   ///< e.g. "tsu:UTC"
+  std::string metadata; ///< encoded key/value pairs
+};
+
+/// Release callback of exported arrays.
+static void
+__release_arrow_array__(ArrowArray* array)
+{
+  auto data = static_cast<arrow_array_data*>(array->private_data);
+  delete[] data->owned;
+  delete data;
+  array->release = nullptr;
+}
+
+/// Release callback of exported schemas.
+static void
+__release_arrow_schema__(ArrowSchema* schema)
+{
+  delete static_cast<arrow_schema_data*>(schema->private_data);
+  schema->release = nullptr;
+}
+
+/// Append a (native endian) int32 to an encoded metadata string.
+static void
+__append_int32__(std::string& str, std::int32_t v)
+{
+  char buf[sizeof v];
+  std::memcpy(buf, &v, sizeof v);
+  str.append(buf, sizeof v);
+}
+
+void
+ngpt::dtchars::arrow_export(const std::int64_t* values, std::int64_t* owned,
+  std::size_t n, ngpt::arrow_time_unit unit, ngpt::time_scale scale,
+  ArrowArray* array, ArrowSchema* schema)
+{
+  arrow_array_data* adata = nullptr;
+  arrow_schema_data* sdata = nullptr;
+  try {
+    adata = new arrow_array_data{{nullptr, values}, owned};
+    sdata = new arrow_schema_data;
+    static constexpr const char* units[] = {"tss:", "tsm:", "tsu:", "tsn:"};
+    sdata->format = units[static_cast<int>(unit)];
+    if (scale == time_scale::utc) sdata->format += "UTC";
+    const std::string key {"ngpt.time_scale"};
+    const std::string val {time_scale_name(scale)};
+    __append_int32__(sdata->metadata, 1);
+    __append_int32__(sdata->metadata, static_cast<std::int32_t>(key.size()));
+    sdata->metadata += key;
+    __append_int32__(sdata->metadata, static_cast<std::int32_t>(val.size()));
+    sdata->metadata += val;
+  } catch (...) {
+    delete[] owned;
+    delete adata;
+    delete sdata;
+    throw;
+  }
+
+  array->length = static_cast<std::int64_t>(n);
+  array->null_count = 0;
+  array->offset = 0;
+  array->n_buffers = 2;
+  array->n_children = 0;
+  array->buffers = adata->buffers;
+  array->children = nullptr;
+  array->dictionary = nullptr;
+  array->release = &__release_arrow_array__;
+  array->private_data = adata;
+
+  schema->format = sdata->format.c_str();
+  schema->name = "";
+  schema->metadata = sdata->metadata.data();
+  schema->flags = 0;
+  schema->n_children = 0;
+  schema->children = nullptr;
+  schema->dictionary = nullptr;
+  schema->release = &__release_arrow_schema__;
+  schema->private_data = sdata;
+}
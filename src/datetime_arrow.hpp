@@ -0,0 +1,213 @@
+///
+/// @file  datetime_arrow.hpp
+///
+/// @brief Export of epoch arrays as Apache Arrow timestamp arrays, via the
+///        Arrow C Data Interface (no dependency on the Arrow libraries).
+///
+/// An array of epochs is exported as a (non-nullable) Arrow timestamp array,
+/// i.e. int64 values counting ticks of the given unit (s, ms, us or ns) since
+/// the Unix epoch (1970-01-01, MJD 40587). Arrow timestamps have no leap
+/// seconds, so the time scale of the epochs (e.g. GPS or TAI) is recorded in
+/// the schema metadata, under the key "ngpt.time_scale"; for UTC epochs the
+/// timezone of the timestamp type is set to "UTC".
+///
+/// The exported ArrowArray and ArrowSchema follow the Arrow C Data Interface
+/// ownership rules: the consumer calls their release callbacks when done.
+/// Epochs are either converted in a single pass into a buffer owned by the
+/// export, or (ngpt::export_arrow_ticks) ticks already in Arrow form are
+/// exported without copying, in which case the producer keeps ownership of
+/// the buffer, which must outlive the exported array.
+///
+/// @code
+///   ArrowArray arr; ArrowSchema sch;
+///   ngpt::export_arrow_timestamps(epochs.data(), epochs.size(), &arr, &sch,
+///     ngpt::time_scale::gps);
+///   // hand over to e.g. pyarrow.Array._import_from_c(arr, sch)
+/// @endcode
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_ARROW__
+#define __NGPT_DT_ARROW__
+
+#include <cstdint>
+#include <cstddef>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "dtchars.hpp"
+#include "datetime_binary.hpp"
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+/// The Arrow C Data Interface schema (as in the Arrow specification).
+struct ArrowSchema
+{
+  const char*          format;
+  const char*          name;
+  const char*          metadata;
+  std::int64_t         flags;
+  std::int64_t         n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema*  dictionary;
+  void (*release)(struct ArrowSchema*);
+  void*                private_data;
+};
+
+/// The Arrow C Data Interface array (as in the Arrow specification).
+struct ArrowArray
+{
+  std::int64_t        length;
+  std::int64_t        null_count;
+  std::int64_t        offset;
+  std::int64_t        n_buffers;
+  std::int64_t        n_children;
+  const void**        buffers;
+  struct ArrowArray** children;
+  struct ArrowArray*  dictionary;
+  void (*release)(struct ArrowArray*);
+  void*               private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace ngpt
+{
+
+/// @enum arrow_time_unit
+/// Units of Arrow timestamps.
+enum class arrow_time_unit
+: char
+{
+  s,  ///< seconds
+  ms, ///< milliseconds
+  us, ///< microseconds
+  ns  ///< nanoseconds
+};// arrow_time_unit
+
+/// The MJD of the Unix (and Arrow) epoch, i.e. 1970-01-01.
+constexpr long unix_epoch_mjd = 40587L;
+
+namespace dtchars
+{
+
+/// @brief Ticks per second of an Arrow time unit.
+constexpr std::int64_t
+arrow_unit_factor(arrow_time_unit u) noexcept
+{
+  switch (u) {
+    case arrow_time_unit::s:  return 1L;
+    case arrow_time_unit::ms: return 1000L;
+    case arrow_time_unit::us: return 1000000L;
+    default:                  return 1000000000L;
+  }
+}
+
+/// @brief Fill in an ArrowArray and ArrowSchema for an int64 timestamp
+///        array (implementation of the export functions).
+///
+/// @param[in] values The values (length n)
+/// @param[in] owned  If not nullptr, a buffer allocated with new[], released
+///                   with the array; values must then point into it
+void
+arrow_export(const std::int64_t* values, std::int64_t* owned, std::size_t n,
+  arrow_time_unit unit, time_scale scale, ArrowArray* array,
+  ArrowSchema* schema);
+
+} // namespace dtchars
+
+/// @brief The Arrow time unit matching the precision of S (i.e. s, ms or us).
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  constexpr arrow_time_unit
+  arrow_native_unit() noexcept
+{
+  constexpr int digits = dtchars::sec_digits<S>();
+  return digits <= 0 ? arrow_time_unit::s
+       : digits <= 3 ? arrow_time_unit::ms
+       : digits <= 6 ? arrow_time_unit::us
+       : arrow_time_unit::ns;
+}
+
+/// @brief Convert epochs to Arrow timestamps, i.e. ticks of the given unit
+///        since the Unix epoch.
+///
+/// If the unit is coarser than S, values are floored. Note that for
+/// nanoseconds, only epochs within about +/-292 years of 1970 fit in an int64.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  to_arrow_ticks(const datetime<S>* epochs, std::size_t n, std::int64_t* out,
+    arrow_time_unit unit=arrow_native_unit<S>()) noexcept
+{
+  constexpr std::int64_t sf = S::template sec_factor<long>();
+  const std::int64_t uf = dtchars::arrow_unit_factor(unit);
+  const std::int64_t per_day = 86400L * uf;
+  if (uf >= sf) {
+    const std::int64_t mul = uf / sf;
+    for (std::size_t i = 0; i < n; i++)
+      out[i] = (epochs[i].mjd().as_underlying_type() - unix_epoch_mjd)
+        * per_day + epochs[i].sec_as_i() * mul;
+  } else {
+    // seconds of day are non-negative, so truncation is flooring
+    const std::int64_t div = sf / uf;
+    for (std::size_t i = 0; i < n; i++)
+      out[i] = (epochs[i].mjd().as_underlying_type() - unix_epoch_mjd)
+        * per_day + epochs[i].sec_as_i() / div;
+  }
+}
+
+/// @brief Export an array of epochs as an Arrow timestamp array.
+///
+/// The epochs are converted (see ngpt::to_arrow_ticks) into a buffer owned by
+/// the exported array (freed by its release callback).
+///
+/// @param[in]  epochs The epochs
+/// @param[in]  n      Number of epochs
+/// @param[out] array  The exported array
+/// @param[out] schema The exported schema, i.e. a timestamp type of the given
+///                    unit, with the time scale in its metadata
+/// @param[in]  scale  The time scale of the epochs
+/// @param[in]  unit   The time unit of the timestamps (default: the precision
+///                    of S)
+/// @throw std::bad_alloc if memory cannot be allocated.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  export_arrow_timestamps(const datetime<S>* epochs, std::size_t n,
+    ArrowArray* array, ArrowSchema* schema,
+    time_scale scale=time_scale::unknown,
+    arrow_time_unit unit=arrow_native_unit<S>())
+{
+  std::int64_t* buf = new std::int64_t[n ? n : 1];
+  to_arrow_ticks(epochs, n, buf, unit);
+  dtchars::arrow_export(buf, buf, n, unit, scale, array, schema);
+}
+
+/// @brief Export (without copying) timestamps already in Arrow form, i.e.
+///        ticks of the given unit since the Unix epoch.
+///
+/// The buffer is not owned by the exported array; it must outlive it.
+///
+/// @throw std::bad_alloc if memory cannot be allocated.
+inline void
+export_arrow_ticks(const std::int64_t* ticks, std::size_t n,
+  arrow_time_unit unit, ArrowArray* array, ArrowSchema* schema,
+  time_scale scale=time_scale::unknown)
+{
+  dtchars::arrow_export(ticks, nullptr, n, unit, scale, array, schema);
+}
+
+} // namespace ngpt
+
+#endif
@@ -0,0 +1,597 @@
+///
+/// @file  datetime_batch.hpp
+///
+/// @brief Batch kernels over arrays of ngpt::datetime, e.g. snapping epochs
+///        to a fixed grid (1 s, 30 s, 5 min, ...) and decimation.
+///
+/// The kernels work on the (MJD, seconds-of-day) pair with integer
+/// arithmetic only, and their loops are written without branches (the
+/// result of each comparison is used arithmetically). When the grid interval
+/// divides the day (the usual 1 s, 30 s, 5 min, ... grids), the remainders
+/// are computed with a precomputed reciprocal (see dtchars::grid_divisor)
+/// instead of a (runtime) division, which has no SIMD form; decimation
+/// computes the keep-mask in a pass of its own, before the (scalar)
+/// compaction of the positions. With these, GCC vectorizes the decimation
+/// loops and the snapping of datetime_vector epochs (e.g. at -O3 with
+/// -march=x86-64-v3). Snapping arrays of datetime (whose constructor
+/// normalizes each epoch) and grids that do not divide the day (which need
+/// a 64-bit division) stay scalar.
+///
+/// All kernels also accept ngpt::datetime_vector (structure-of-arrays)
+/// arguments, where the MJD and seconds arrays are processed directly.
+///
+/// Calendar bucketing (hour, day, GPS week, day of year, month) also uses
+/// integer arithmetic on the MJD only (the calendar date is computed with
+/// the era-based algorithm of H. Hinnant), and the bucket keys can be counted
+/// with ngpt::histogram.
+///
+/// Grids are anchored at midnight; if the interval does not divide the day,
+/// the grid is anchored at MJD 0 (i.e. it runs continuously over days).
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_BATCH__
+#define __NGPT_DT_BATCH__
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_binary.hpp"
+#include "datetime_vector.hpp"
+
+namespace ngpt
+{
+
+/// @enum snap_mode
+/// How to snap an epoch to a grid.
+enum class snap_mode
+: char
+{
+  nearest, ///< to the nearest grid point (half-way epochs are rounded up)
+  floor,   ///< to the grid point at or before the epoch
+  ceil     ///< to the grid point at or after the epoch
+};// snap_mode
+
+/// @enum bucket_unit
+/// Calendar buckets of ngpt::bucketize, and the resulting keys.
+enum class bucket_unit
+: char
+{
+  hour,        ///< hours since MJD 0, i.e. MJD*24 + hour of day
+  day,         ///< the MJD
+  gps_week,    ///< the GPS week
+  day_of_year, ///< the day of year (1 to 366)
+  month        ///< months since year 0, i.e. year*12 + month - 1
+};// bucket_unit
+
+namespace dtchars
+{
+
+/// @brief Validate a grid interval (in ticks of S).
+/// @throw std::invalid_argument if the interval is not positive.
+inline void
+check_interval(long iv, const char* caller)
+{
+  if (iv <= 0L)
+    throw std::invalid_argument(std::string(caller)
+      + ": grid interval must be positive");
+}
+
+/// @brief High 64 bits of the 128-bit product a*b (from 32-bit halves, so
+///        that it only needs 32x32->64 bit multiplications).
+constexpr std::uint64_t
+mul_high(std::uint64_t a, std::uint64_t b) noexcept
+{
+  const std::uint64_t alo = a & 0xffffffffULL, ahi = a >> 32;
+  const std::uint64_t blo = b & 0xffffffffULL, bhi = b >> 32;
+  const std::uint64_t ll = alo * blo, hl = ahi * blo;
+  const std::uint64_t cross = (ll >> 32) + (hl & 0xffffffffULL) + alo * bhi;
+  return ahi * bhi + (hl >> 32) + (cross >> 32);
+}
+
+/// @brief Remainders of the division by a fixed (positive) divisor d, via
+///        the reciprocal m = floor((2^64-1)/d): for 0 <= x < 2^63, the
+///        quotient estimate mul_high(x, m) is floor(x/d) or one less, so a
+///        single (branch-free) correction gives the exact remainder.
+struct grid_divisor
+{
+  long          d; ///< the divisor
+  std::uint64_t m; ///< its reciprocal
+
+  explicit constexpr
+  grid_divisor(long divisor) noexcept
+    : d{divisor}, m{~std::uint64_t{0} / static_cast<std::uint64_t>(divisor)}
+  {}
+
+  /// x mod d, for 0 <= x < 2^63.
+  constexpr long
+  remainder(long x) const noexcept
+  {
+    const long q = static_cast<long>(mul_high(static_cast<std::uint64_t>(x),
+                                              m));
+    const long r = x - q * d;
+    return r - d * (r >= d);
+  }
+};// grid_divisor
+
+/// @brief Compact the positions of a keep-mask: on input, idx[i] is 1 if the
+///        i-th element is kept (0 otherwise); on output, the first (returned)
+///        number of elements of idx are the positions kept, in order.
+inline std::size_t
+compact_mask(std::size_t* idx, std::size_t n) noexcept
+{
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    const std::size_t keep = idx[i];
+    idx[k] = i;
+    k += keep;
+  }
+  return k;
+}
+
+/// @brief Calendar year, month (1-12) and day of year (1-366) of an MJD,
+///        with integer arithmetic only (H. Hinnant's civil_from_days).
+constexpr void
+civil_from_mjd(long mjd, long& y, long& m, long& doy) noexcept
+{
+  const long z = mjd + 678881L; // days since 0000-03-01
+  const long era = (z >= 0 ? z : z - 146096L) / 146097L;
+  const long doe = z - era * 146097L;
+  const long yoe = (doe - doe / 1460L + doe / 36524L - doe / 146096L) / 365L;
+  const long doy_mar = doe - (365L * yoe + yoe / 4L - yoe / 100L);
+  const long mp = (5L * doy_mar + 2L) / 153L;
+  const long jan_feb = (mp >= 10L);
+  y = yoe + era * 400L + jan_feb;
+  m = mp + 3L - 12L * jan_feb;
+  const long leap = (y % 4L == 0L) & ((y % 100L != 0L) | (y % 400L == 0L));
+  doy = doy_mar + 1L + (1L - jan_feb) * (59L + leap) - jan_feb * 306L;
+}
+
+/// @brief Bucket key of an epoch (given as MJD and ticks of S of the day).
+template<typename S>
+  constexpr long
+  bucket_key(long mjd, long sec, bucket_unit unit) noexcept
+{
+  long y = 0, m = 0, doy = 0;
+  switch (unit) {
+    case bucket_unit::hour:
+      return mjd * 24L + sec / (S::max_in_day / 24L);
+    case bucket_unit::day:
+      return mjd;
+    case bucket_unit::gps_week: {
+      const long d = mjd - jan61980;
+      return (d >= 0 ? d : d - 6L) / 7L; }
+    case bucket_unit::day_of_year:
+      civil_from_mjd(mjd, y, m, doy);
+      return doy;
+    default:
+      civil_from_mjd(mjd, y, m, doy);
+      return y * 12L + m - 1L;
+  }
+}
+
+} // namespace dtchars
+
+/// @brief Snap an array of epochs to a grid of the given interval.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+/// @param[in]  in       The epochs
+/// @param[in]  n        Number of epochs
+/// @param[in]  interval The grid interval (positive)
+/// @param[in]  mode     How to snap
+/// @param[out] out      The snapped epochs (may be the same array as in)
+/// @throw std::invalid_argument if the interval is not positive.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  snap_to_grid(const datetime<S>* in, std::size_t n, S interval,
+    snap_mode mode, datetime<S>* out)
+{
+  const long iv = interval.as_underlying_type();
+  dtchars::check_interval(iv, "snap_to_grid");
+  const long round = (mode == snap_mode::nearest) ? (iv + 1) / 2
+                   : (mode == snap_mode::ceil) ? 1L : iv + 1;
+
+  if (!(S::max_in_day % iv)) {
+    // the grid divides the day; only the seconds of day are snapped
+    const dtchars::grid_divisor grid {iv};
+    for (std::size_t i = 0; i < n; i++) {
+      const long sec = in[i].sec_as_i();
+      const long r = grid.remainder(sec);
+      long s = sec - r + iv * (r >= round);
+      const long carry = (s >= S::max_in_day);
+      s -= carry * S::max_in_day;
+      out[i] = datetime<S>{modified_julian_day{
+        in[i].mjd().as_underlying_type() + carry}, S{s}};
+    }
+  } else {
+    for (std::size_t i = 0; i < n; i++) {
+      const std::int64_t ticks = to_linear_ticks(in[i]);
+      std::int64_t r = ticks % iv;
+      r += iv * (r < 0);
+      out[i] = from_linear_ticks<S>(ticks - r + iv * (r >= round));
+    }
+  }
+}
+
+/// @brief Decimate an array of epochs, i.e. find the epochs lying on a grid
+///        (within a tolerance).
+///
+/// @param[in]  in       The epochs
+/// @param[in]  n        Number of epochs
+/// @param[in]  interval The grid interval (positive)
+/// @param[in]  tol      Maximum distance of an epoch from its nearest grid
+///                      point, for the epoch to be kept
+/// @param[out] idx      The positions of the epochs kept, in order; must have
+///                      room for n positions
+/// @return The number of epochs kept.
+/// @throw std::invalid_argument if the interval is not positive.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::size_t
+  decimate(const datetime<S>* in, std::size_t n, S interval, S tol,
+    std::size_t* idx)
+{
+  const long iv = interval.as_underlying_type();
+  dtchars::check_interval(iv, "decimate");
+  const long t = tol.as_underlying_type();
+  if (!(S::max_in_day % iv)) {
+    const dtchars::grid_divisor grid {iv};
+    for (std::size_t i = 0; i < n; i++) {
+      const long r = grid.remainder(in[i].sec_as_i());
+      idx[i] = (r <= t) | (iv - r <= t);
+    }
+  } else {
+    for (std::size_t i = 0; i < n; i++) {
+      std::int64_t r = to_linear_ticks(in[i]) % iv;
+      r += iv * (r < 0);
+      idx[i] = (r <= t) | (iv - r <= t);
+    }
+  }
+  return dtchars::compact_mask(idx, n);
+}
+
+/// @brief Snap the epochs of a datetime_vector to a grid.
+///
+/// @see ngpt::snap_to_grid for the parameters; out is resized to in.size()
+///      (and may be the same vector as in).
+/// @throw std::invalid_argument if the interval is not positive.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  snap_to_grid(const datetime_vector<S>& in, S interval, snap_mode mode,
+    datetime_vector<S>& out)
+{
+  const long iv = interval.as_underlying_type();
+  dtchars::check_interval(iv, "snap_to_grid");
+  const long round = (mode == snap_mode::nearest) ? (iv + 1) / 2
+                   : (mode == snap_mode::ceil) ? 1L : iv + 1;
+  const std::size_t n = in.size();
+  out.resize(n);
+  const auto* imjd = in.mjd_data();
+  const auto* isec = in.sec_data();
+  auto* omjd = out.mjd_data();
+  auto* osec = out.sec_data();
+
+  if (!(S::max_in_day % iv)) {
+    const dtchars::grid_divisor grid {iv};
+    for (std::size_t i = 0; i < n; i++) {
+      const long r = grid.remainder(isec[i]);
+      long s = isec[i] - r + iv * (r >= round);
+      const long carry = (s >= S::max_in_day);
+      osec[i] = s - carry * S::max_in_day;
+      omjd[i] = imjd[i] + carry;
+    }
+  } else {
+    for (std::size_t i = 0; i < n; i++) {
+      const std::int64_t ticks = imjd[i] * S::max_in_day + isec[i];
+      std::int64_t r = ticks % iv;
+      r += iv * (r < 0);
+      const std::int64_t t = ticks - r + iv * (r >= round);
+      std::int64_t d = t / S::max_in_day;
+      std::int64_t s = t % S::max_in_day;
+      d -= (s < 0);
+      s += S::max_in_day * (s < 0);
+      omjd[i] = d;
+      osec[i] = s;
+    }
+  }
+}
+
+/// @brief Decimate the epochs of a datetime_vector.
+///
+/// @see ngpt::decimate for the parameters (idx must have room for
+///      in.size() positions).
+/// @throw std::invalid_argument if the interval is not positive.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::size_t
+  decimate(const datetime_vector<S>& in, S interval, S tol, std::size_t* idx)
+{
+  const long iv = interval.as_underlying_type();
+  dtchars::check_interval(iv, "decimate");
+  const long t = tol.as_underlying_type();
+  const auto* mjd = in.mjd_data();
+  const auto* sec = in.sec_data();
+  const std::size_t n = in.size();
+  if (!(S::max_in_day % iv)) {
+    const dtchars::grid_divisor grid {iv};
+    for (std::size_t i = 0; i < n; i++) {
+      const long r = grid.remainder(sec[i]);
+      idx[i] = (r <= t) | (iv - r <= t);
+    }
+  } else {
+    for (std::size_t i = 0; i < n; i++) {
+      std::int64_t r = (mjd[i] * S::max_in_day + sec[i]) % iv;
+      r += iv * (r < 0);
+      idx[i] = (r <= t) | (iv - r <= t);
+    }
+  }
+  return dtchars::compact_mask(idx, n);
+}
+
+/// @brief Calendar dates (year, month, day of month) of the epochs of a
+///        datetime_vector; out must have room for v.size() dates.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  to_ymd(const datetime_vector<S>& v, ymd_date* out) noexcept
+{
+  const auto* mjd = v.mjd_data();
+  for (std::size_t i = 0; i < v.size(); i++)
+    out[i] = modified_julian_day{mjd[i]}.to_ymd();
+}
+
+/// @brief TAI-UTC (in seconds, see ngpt::dat) at the epochs of a
+///        datetime_vector; out must have room for v.size() values.
+///
+/// The (table) lookup is only performed when the day changes.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  dat(const datetime_vector<S>& v, int* out) noexcept
+{
+  const auto* mjd = v.mjd_data();
+  long prev = 0L;
+  int  val = 0;
+  for (std::size_t i = 0; i < v.size(); i++) {
+    if (!i || mjd[i] != prev) {
+      prev = mjd[i];
+      val = ngpt::dat(modified_julian_day{prev});
+    }
+    out[i] = val;
+  }
+}
+
+/// @brief Differences a[i] - b[i] of the epochs of two datetime_vectors,
+///        in ticks of S; the vectors must have the same size and out must
+///        have room for a.size() values.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  delta_sec(const datetime_vector<S>& a, const datetime_vector<S>& b,
+    typename S::underlying_type* out) noexcept
+{
+  const auto* am = a.mjd_data();
+  const auto* as = a.sec_data();
+  const auto* bm = b.mjd_data();
+  const auto* bs = b.sec_data();
+  for (std::size_t i = 0; i < a.size(); i++)
+    out[i] = (am[i] - bm[i]) * S::max_in_day + (as[i] - bs[i]);
+}
+
+/// @brief Differences t[i] - ref (as ngpt::delta_sec) of an array of epochs
+///        from a reference epoch, in ticks of the more precise of S1, S2.
+///
+/// The cast to the more precise type is a compile-time factor; the loop is
+/// plain integer arithmetic on (MJD, seconds of day), so that it can be
+/// vectorized.
+///
+/// @param[in]  t   The epochs
+/// @param[in]  n   Number of epochs
+/// @param[in]  ref The reference epoch
+/// @param[out] out The differences; must have room for n values
+template<typename S1, typename S2,
+        typename = std::enable_if_t<S1::is_of_sec_type>,
+        typename = std::enable_if_t<S2::is_of_sec_type>
+        >
+  void
+  delta_sec(const datetime<S2>* t, std::size_t n, const datetime<S1>& ref,
+    typename finer_sec_t<S1, S2>::underlying_type* out) noexcept
+{
+  using F = finer_sec_t<S1, S2>;
+  constexpr long f2 = F::max_in_day / S2::max_in_day;
+  const long r = ref.mjd().as_underlying_type() * F::max_in_day
+    + ref.sec_as_i() * (F::max_in_day / S1::max_in_day);
+  for (std::size_t i = 0; i < n; i++)
+    out[i] = t[i].mjd().as_underlying_type() * F::max_in_day
+      + t[i].sec_as_i() * f2 - r;
+}
+
+/// @brief Differences t[i] - ref of an array of epochs from a reference
+///        epoch, in (fractional) seconds.
+/// @see ngpt::delta_sec(const datetime<S2>*, std::size_t,
+///      const datetime<S1>&, finer_sec_t<S1, S2>::underlying_type*)
+template<typename S1, typename S2,
+        typename = std::enable_if_t<S1::is_of_sec_type>,
+        typename = std::enable_if_t<S2::is_of_sec_type>
+        >
+  void
+  delta_sec(const datetime<S2>* t, std::size_t n, const datetime<S1>& ref,
+    double* out) noexcept
+{
+  using F = finer_sec_t<S1, S2>;
+  constexpr long f2 = F::max_in_day / S2::max_in_day;
+  constexpr double spt = 86400e0 / F::max_in_day;
+  const long r = ref.mjd().as_underlying_type() * F::max_in_day
+    + ref.sec_as_i() * (F::max_in_day / S1::max_in_day);
+  for (std::size_t i = 0; i < n; i++)
+    out[i] = static_cast<double>(t[i].mjd().as_underlying_type()
+      * F::max_in_day + t[i].sec_as_i() * f2 - r) * spt;
+}
+
+/// @brief Differences v[i] - ref of the epochs of a datetime_vector from a
+///        reference epoch, in (fractional) seconds; out must have room for
+///        v.size() values.
+template<typename S1, typename S2,
+        typename = std::enable_if_t<S1::is_of_sec_type>,
+        typename = std::enable_if_t<S2::is_of_sec_type>
+        >
+  void
+  delta_sec(const datetime_vector<S2>& v, const datetime<S1>& ref,
+    double* out) noexcept
+{
+  using F = finer_sec_t<S1, S2>;
+  constexpr long f2 = F::max_in_day / S2::max_in_day;
+  constexpr double spt = 86400e0 / F::max_in_day;
+  const long r = ref.mjd().as_underlying_type() * F::max_in_day
+    + ref.sec_as_i() * (F::max_in_day / S1::max_in_day);
+  const auto* mjd = v.mjd_data();
+  const auto* sec = v.sec_data();
+  for (std::size_t i = 0; i < v.size(); i++)
+    out[i] = static_cast<double>(mjd[i] * F::max_in_day + sec[i] * f2 - r)
+      * spt;
+}
+
+/// @brief Signed intervals t[i] - ref (as ngpt::delta_date) of an array of
+///        epochs from a reference epoch.
+///
+/// The intervals are normalized to floor form (see ngpt::datetime_interval)
+/// without branches, and stored as they are (i.e. without normalizing them
+/// again on construction), so that the loop can be vectorized.
+///
+/// @param[in]  t   The epochs
+/// @param[in]  n   Number of epochs
+/// @param[in]  ref The reference epoch
+/// @param[out] out The intervals; must have room for n intervals
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  delta_date(const datetime<S>* t, std::size_t n, const datetime<S>& ref,
+    datetime_interval<S>* out) noexcept
+{
+  const long rm = ref.mjd().as_underlying_type();
+  const long rs = ref.sec_as_i();
+  for (std::size_t i = 0; i < n; i++) {
+    // seconds of day are in [0, max_in_day), so their difference needs at
+    // most one borrow
+    const long s = t[i].sec_as_i() - rs;
+    const long neg = (s < 0);
+    out[i] = dtchars::interval_access::floor_form<S>(
+      t[i].mjd().as_underlying_type() - rm - neg,
+      static_cast<typename S::underlying_type>(s + neg * S::max_in_day));
+  }
+}
+
+/// @brief Signed intervals v[i] - ref of the epochs of a datetime_vector from
+///        a reference epoch, as separate day and *seconds arrays (floor
+///        form, see ngpt::delta_date); days and secs must have room for
+///        v.size() values.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  delta_date(const datetime_vector<S>& v, const datetime<S>& ref, long* days,
+    typename S::underlying_type* secs) noexcept
+{
+  const long rm = ref.mjd().as_underlying_type();
+  const long rs = ref.sec_as_i();
+  const auto* mjd = v.mjd_data();
+  const auto* sec = v.sec_data();
+  for (std::size_t i = 0; i < v.size(); i++) {
+    const long s = sec[i] - rs;
+    const long neg = (s < 0);
+    days[i] = mjd[i] - rm - neg;
+    secs[i] = s + neg * S::max_in_day;
+  }
+}
+
+/// @brief Map an array of epochs to calendar bucket keys (see
+///        ngpt::bucket_unit for the keys).
+///
+/// @param[in]  in   The epochs
+/// @param[in]  n    Number of epochs
+/// @param[in]  unit The buckets
+/// @param[out] out  The bucket keys; must have room for n keys
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  bucketize(const datetime<S>* in, std::size_t n, bucket_unit unit,
+    long* out) noexcept
+{
+  for (std::size_t i = 0; i < n; i++)
+    out[i] = dtchars::bucket_key<S>(in[i].mjd().as_underlying_type(),
+      in[i].sec_as_i(), unit);
+}
+
+/// @brief Map the epochs of a datetime_vector to calendar bucket keys.
+/// @see ngpt::bucketize (out must have room for v.size() keys).
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  bucketize(const datetime_vector<S>& v, bucket_unit unit, long* out)
+    noexcept
+{
+  const auto* mjd = v.mjd_data();
+  const auto* sec = v.sec_data();
+  for (std::size_t i = 0; i < v.size(); i++)
+    out[i] = dtchars::bucket_key<S>(mjd[i], sec[i], unit);
+}
+
+/// @brief Count the keys falling in each of the bins first, first+1, ...,
+///        first+nbins-1.
+///
+/// Counting is spread over four private sub-histograms (one per key in
+/// groups of four), so that consecutive equal keys do not serialize on the
+/// same counter; keys outside the bins go to a spare bin (no branches).
+///
+/// @param[in]     keys   The keys (e.g. from ngpt::bucketize)
+/// @param[in]     n      Number of keys
+/// @param[in]     first  Key of the first bin
+/// @param[in]     nbins  Number of bins
+/// @param[in,out] counts The counts of the nbins bins; they are added to
+///                       (i.e. they must be initialized)
+/// @return The number of keys outside the bins.
+inline std::size_t
+histogram(const long* keys, std::size_t n, long first, std::size_t nbins,
+  std::size_t* counts)
+{
+  const std::size_t w = nbins + 1;
+  std::vector<std::size_t> sub(4 * w, 0);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (std::size_t k = 0; k < 4; k++) {
+      const std::size_t b = static_cast<std::size_t>(keys[i+k] - first);
+      ++sub[k * w + (b < nbins ? b : nbins)];
+    }
+  }
+  for (; i < n; i++) {
+    const std::size_t b = static_cast<std::size_t>(keys[i] - first);
+    ++sub[b < nbins ? b : nbins];
+  }
+  for (std::size_t b = 0; b < nbins; b++)
+    counts[b] += sub[b] + sub[w + b] + sub[2 * w + b] + sub[3 * w + b];
+  return sub[nbins] + sub[w + nbins] + sub[2 * w + nbins] + sub[3 * w + nbins];
+}
+
+} // namespace ngpt
+
+#endif
@@ -0,0 +1,130 @@
+///
+/// @file  datetime_binary.cpp
+///
+/// @brief Implementation file for the (non-template) parts of header
+///        datetime_binary.hpp, i.e. the file header and memory mapping.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#include "datetime_binary.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Magic number of binary epoch files.
+constexpr static char epoch_file_magic[4] = {'N', 'G', 'D', 'T'};
+
+/// Throw an std::runtime_error, describing the current errno.
+[[noreturn]] static void
+__throw_errno__(const char* what, const char* path)
+{
+  throw std::runtime_error(std::string(what) + " \"" + path + "\": "
+    + std::strerror(errno));
+}
+
+namespace
+{
+
+/// Closes a file descriptor on scope exit, i.e. after any exception (and its
+/// errno-based message) has been created.
+struct fd_guard
+{
+  int fd;
+  ~fd_guard() noexcept { if (fd >= 0) ::close(fd); }
+};
+
+} // namespace
+
+void
+ngpt::encode_header(const ngpt::epoch_file_header& hdr, unsigned char* buf)
+noexcept
+{
+  std::memset(buf, 0, epoch_file_header::size);
+  std::memcpy(buf, epoch_file_magic, 4);
+  buf[4] = static_cast<unsigned char>(hdr.version);
+  buf[5] = static_cast<unsigned char>(hdr.version >> 8);
+  buf[6] = hdr.precision;
+  buf[7] = static_cast<unsigned char>(hdr.scale);
+  buf[8] = static_cast<unsigned char>(epoch_file_header::record_size);
+  ngpt::store_le64(buf + 16, hdr.count);
+}
+
+///
+/// Records of a different size, or versions newer than the current one,
+/// cannot be read and are reported as errors.
+///
+ngpt::epoch_file_header
+ngpt::decode_header(const unsigned char* buf, std::size_t n)
+{
+  if (n < epoch_file_header::size)
+    throw std::runtime_error("decode_header: truncated epoch file header");
+  if (std::memcmp(buf, epoch_file_magic, 4))
+    throw std::runtime_error("decode_header: not an epoch file (bad magic)");
+
+  epoch_file_header hdr;
+  hdr.version = static_cast<std::uint16_t>(buf[4] | (buf[5] << 8));
+  if (!hdr.version || hdr.version > epoch_file_header::current_version)
+    throw std::runtime_error("decode_header: unsupported epoch file version "
+      + std::to_string(hdr.version));
+  const std::uint32_t rsize = buf[8] | (buf[9] << 8) | (buf[10] << 16)
+    | (static_cast<std::uint32_t>(buf[11]) << 24);
+  if (rsize != epoch_file_header::record_size)
+    throw std::runtime_error("decode_header: unsupported record size "
+      + std::to_string(rsize));
+  hdr.precision = buf[6];
+  hdr.scale = static_cast<time_scale>(buf[7]);
+  hdr.count = ngpt::load_le64(buf + 16);
+  return hdr;
+}
+
+ngpt::mapped_file::mapped_file(const char* path)
+  : m_data{nullptr},
+    m_size{0}
+{
+  const fd_guard file {::open(path, O_RDONLY)};
+  if (file.fd < 0) __throw_errno__("mapped_file: failed to open", path);
+  struct stat st;
+  if (::fstat(file.fd, &st))
+    __throw_errno__("mapped_file: failed to stat", path);
+  m_size = static_cast<std::size_t>(st.st_size);
+  if (m_size) {
+    void* ptr = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file.fd, 0);
+    if (ptr == MAP_FAILED) __throw_errno__("mapped_file: failed to map", path);
+    m_data = static_cast<unsigned char*>(ptr);
+  }
+}
+
+ngpt::mapped_file::mapped_file(const char* path, std::size_t size)
+  : m_data{nullptr},
+    m_size{size}
+{
+  const fd_guard file {::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)};
+  if (file.fd < 0) __throw_errno__("mapped_file: failed to create", path);
+  if (::ftruncate(file.fd, static_cast<off_t>(size)))
+    __throw_errno__("mapped_file: failed to resize", path);
+  if (m_size) {
+    void* ptr = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      file.fd, 0);
+    if (ptr == MAP_FAILED) __throw_errno__("mapped_file: failed to map", path);
+    m_data = static_cast<unsigned char*>(ptr);
+  }
+}
+
+ngpt::mapped_file::mapped_file(ngpt::mapped_file&& other) noexcept
+  : m_data{other.m_data},
+    m_size{other.m_size}
+{
+  other.m_data = nullptr;
+  other.m_size = 0;
+}
+
+ngpt::mapped_file::~mapped_file() noexcept
+{
+  if (m_data) ::munmap(m_data, m_size);
+}
@@ -0,0 +1,342 @@
+///
+/// @file  datetime_binary.hpp
+///
+/// @brief A compact, fixed-size binary encoding of ngpt::datetime and files
+///        of epochs (accessed via mmap).
+///
+/// Each epoch is encoded in 8 bytes, as a (signed, two's complement) little
+/// endian integer holding the number of ticks of the second type since MJD 0,
+/// i.e. mjd * S::max_in_day + sec. The precision (i.e. the second type) is
+/// not part of the record; it is stored (once) in the file header.
+///
+/// A file of epochs is made up of a 32-byte header, followed by the records:
+/// @code
+///   offset size  description
+///   0      4     magic number, "NGDT"
+///   4      2     format version (currently 1), uint16 little endian
+///   6      1     precision tag, i.e. fractional digits of the second type
+///                (0 for seconds, 3 for milliseconds, 6 for microseconds)
+///   7      1     time scale (see ngpt::time_scale)
+///   8      4     record size in bytes (8), uint32 little endian
+///   12     4     reserved (zero)
+///   16     8     number of records, uint64 little endian
+///   24     8     reserved (zero)
+///   32     8*n   records
+/// @endcode
+///
+/// Files are written and read via mmap; a ngpt::epoch_file_view maps a file
+/// and exposes its records as an array, with no decoding pass (each record is
+/// decoded on access, which is a single load on little endian hosts).
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_BINARY__
+#define __NGPT_DT_BINARY__
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "dtchars.hpp"
+#include "gnsstm.hpp"
+
+namespace ngpt
+{
+
+/// @enum time_scale
+/// Time scales, as stored in the header of binary epoch files.
+enum class time_scale
+: std::uint8_t
+{
+  unknown = 0, ///< not specified
+  utc,         ///< Coordinated Universal Time
+  tai,         ///< International Atomic Time
+  tt,          ///< Terrestrial Time
+  gps,         ///< GPS time
+  glo,         ///< GLONASS (UTC) time
+  gal,         ///< Galileo time
+  qzs,         ///< QZSS time
+  bdt,         ///< BDS time
+  irn          ///< IRNSS time
+};// time_scale
+
+/// @brief The time_scale corresponding to a ngpt::GnssTimeSystem.
+constexpr time_scale
+to_time_scale(GnssTimeSystem ts) noexcept
+{
+  switch (ts) {
+    case GnssTimeSystem::gps: return time_scale::gps;
+    case GnssTimeSystem::glo: return time_scale::glo;
+    case GnssTimeSystem::gal: return time_scale::gal;
+    case GnssTimeSystem::qzs: return time_scale::qzs;
+    case GnssTimeSystem::bdt: return time_scale::bdt;
+    case GnssTimeSystem::irn: return time_scale::irn;
+  }
+  return time_scale::unknown;
+}
+
+/// @brief A (lowercase) name for a time_scale, e.g. "gps".
+constexpr const char*
+time_scale_name(time_scale ts) noexcept
+{
+  switch (ts) {
+    case time_scale::utc: return "utc";
+    case time_scale::tai: return "tai";
+    case time_scale::tt:  return "tt";
+    case time_scale::gps: return "gps";
+    case time_scale::glo: return "glo";
+    case time_scale::gal: return "gal";
+    case time_scale::qzs: return "qzs";
+    case time_scale::bdt: return "bdt";
+    case time_scale::irn: return "irn";
+    default:              return "unknown";
+  }
+}
+
+/// @struct epoch_file_header
+/// The (decoded) header of a binary epoch file.
+struct epoch_file_header
+{
+  /// Size of the (encoded) header in bytes.
+  static constexpr std::size_t size = 32;
+  /// Size of an (encoded) epoch record in bytes.
+  static constexpr std::size_t record_size = 8;
+  /// Current format version.
+  static constexpr std::uint16_t current_version = 1;
+
+  std::uint16_t version {current_version};     ///< format version
+  std::uint8_t  precision {0};                 ///< fractional digits of S
+  time_scale    scale {time_scale::unknown};   ///< time scale of the epochs
+  std::uint64_t count {0};                     ///< number of records
+};// epoch_file_header
+
+/// @brief Encode a header into (exactly) epoch_file_header::size bytes.
+void
+encode_header(const epoch_file_header& hdr, unsigned char* buf) noexcept;
+
+/// @brief Decode and validate a header.
+///
+/// @param[in] buf The encoded header
+/// @param[in] n   Number of bytes available in buf
+/// @return        The decoded header
+/// @throw std::runtime_error if the header is truncated, has a wrong magic
+///        number, an unsupported version or record size.
+epoch_file_header
+decode_header(const unsigned char* buf, std::size_t n);
+
+/// @brief Store a 64-bit integer in little endian byte order.
+inline void
+store_le64(unsigned char* p, std::uint64_t v) noexcept
+{
+  for (int i = 0; i < 8; i++) p[i] = static_cast<unsigned char>(v >> (8*i));
+}
+
+/// @brief Load a 64-bit integer stored in little endian byte order.
+inline std::uint64_t
+load_le64(const unsigned char* p) noexcept
+{
+  std::uint64_t v = 0;
+  for (int i = 0; i < 8; i++) v |= static_cast<std::uint64_t>(p[i]) << (8*i);
+  return v;
+}
+
+/// @brief Ticks of S since MJD 0 (i.e. the binary representation).
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  constexpr std::int64_t
+  to_linear_ticks(const datetime<S>& t) noexcept
+{
+  return static_cast<std::int64_t>(t.mjd().as_underlying_type())
+    * S::max_in_day + t.sec_as_i();
+}
+
+/// @brief The datetime from ticks of S since MJD 0 (inverse of
+///        ngpt::to_linear_ticks).
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  datetime<S>
+  from_linear_ticks(std::int64_t ticks) noexcept
+{
+  std::int64_t days = ticks / S::max_in_day;
+  std::int64_t secs = ticks % S::max_in_day;
+  if (secs < 0) {
+    --days;
+    secs += S::max_in_day;
+  }
+  return datetime<S>{modified_julian_day{static_cast<long>(days)},
+                     S{static_cast<long>(secs)}};
+}
+
+/// @brief Encode n epochs into (exactly) n*epoch_file_header::record_size
+///        bytes.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  encode_epochs(const datetime<S>* epochs, std::size_t n, unsigned char* out)
+  noexcept
+{
+  for (std::size_t i = 0; i < n; i++, out += epoch_file_header::record_size)
+    store_le64(out, static_cast<std::uint64_t>(to_linear_ticks(epochs[i])));
+}
+
+/// @brief Decode n records into epochs.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  decode_epochs(const unsigned char* in, std::size_t n, datetime<S>* epochs)
+  noexcept
+{
+  for (std::size_t i = 0; i < n; i++, in += epoch_file_header::record_size)
+    epochs[i] = from_linear_ticks<S>(static_cast<std::int64_t>(load_le64(in)));
+}
+
+/// @brief A file mapped in memory (via mmap); the mapping is released on
+///        destruction.
+class mapped_file
+{
+public:
+  /// @brief Map an existing file (read-only).
+  /// @throw std::runtime_error if the file cannot be opened or mapped.
+  explicit
+  mapped_file(const char* path);
+
+  /// @brief Create (or truncate) a file of the given size and map it
+  ///        (read-write); changes are written to the file.
+  /// @throw std::runtime_error if the file cannot be created or mapped.
+  mapped_file(const char* path, std::size_t size);
+
+  /// Unmap the file.
+  ~mapped_file() noexcept;
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  /// Move constructor.
+  mapped_file(mapped_file&& other) noexcept;
+
+  /// Start of the mapped data.
+  unsigned char*
+  data() noexcept
+  { return m_data; }
+
+  /// Start of the mapped data (const).
+  const unsigned char*
+  data() const noexcept
+  { return m_data; }
+
+  /// Size of the mapped data in bytes.
+  std::size_t
+  size() const noexcept
+  { return m_size; }
+
+private:
+  unsigned char* m_data; ///< the mapping
+  std::size_t    m_size; ///< size of the mapping in bytes
+};// mapped_file
+
+/// @brief Write an array of epochs to a binary epoch file.
+///
+/// The file is created (or truncated), sized and mapped; the records are
+/// encoded directly in the mapping.
+///
+/// @throw std::runtime_error if the file cannot be created or mapped.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  void
+  write_epoch_file(const char* path, const datetime<S>* epochs, std::size_t n,
+    time_scale scale=time_scale::unknown)
+{
+  epoch_file_header hdr;
+  hdr.precision = static_cast<std::uint8_t>(dtchars::sec_digits<S>());
+  hdr.scale = scale;
+  hdr.count = n;
+  mapped_file file {path,
+    epoch_file_header::size + n * epoch_file_header::record_size};
+  encode_header(hdr, file.data());
+  encode_epochs(epochs, n, file.data() + epoch_file_header::size);
+}
+
+/// @brief A read-only view of a binary epoch file, i.e. an array of
+///        datetime<S>, backed by the mapped file.
+///
+/// @tparam S The second type; must match the precision of the file.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class epoch_file_view
+{
+public:
+  /// @brief Map a binary epoch file.
+  /// @throw std::runtime_error if the file cannot be mapped, its header is
+  ///        invalid, it is truncated, or its precision does not match S.
+  explicit
+  epoch_file_view(const char* path)
+    : m_file{path},
+      m_hdr{decode_header(m_file.data(), m_file.size())}
+  {
+    if (m_hdr.precision != dtchars::sec_digits<S>())
+      throw std::runtime_error("epoch_file_view: precision of file \""
+        + std::string(path) + "\" does not match the second type");
+    if ((m_file.size() - epoch_file_header::size)
+      / epoch_file_header::record_size < m_hdr.count)
+      throw std::runtime_error("epoch_file_view: file \"" + std::string(path)
+        + "\" is truncated");
+  }
+
+  /// Number of epochs.
+  std::size_t
+  size() const noexcept
+  { return m_hdr.count; }
+
+  /// The file header.
+  const epoch_file_header&
+  header() const noexcept
+  { return m_hdr; }
+
+  /// The i-th epoch as ticks of S since MJD 0 (no bounds check).
+  std::int64_t
+  ticks(std::size_t i) const noexcept
+  { return static_cast<std::int64_t>(load_le64(records() + 8 * i)); }
+
+  /// The i-th epoch (no bounds check).
+  datetime<S>
+  operator[](std::size_t i) const noexcept
+  { return from_linear_ticks<S>(ticks(i)); }
+
+  /// Pointer to the (encoded) records.
+  const unsigned char*
+  records() const noexcept
+  { return m_file.data() + epoch_file_header::size; }
+
+  /// @brief The records as an array of ticks (since MJD 0), for direct,
+  ///        zero-copy access.
+  /// @return The array, or nullptr on big endian hosts, where the records
+  ///         need to be decoded (see epoch_file_view::ticks).
+  const std::int64_t*
+  tick_data() const noexcept
+  {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return reinterpret_cast<const std::int64_t*>(records());
+#else
+    return nullptr;
+#endif
+  }
+
+private:
+  mapped_file       m_file; ///< the mapped file
+  epoch_file_header m_hdr;  ///< the (decoded) header
+};// epoch_file_view
+
+} // namespace ngpt
+
+#endif
@@ -0,0 +1,304 @@
+///
+/// @file  datetime_bulk_write.hpp
+///
+/// @brief Bulk formatting of ngpt::datetime sequences to a file descriptor.
+///
+/// Output files of (high-rate) time series, hold a large number of epochs
+/// that (almost always) share the same day. The ngpt::epoch_writer class
+/// renders the date part of an epoch only when the day changes (i.e. it
+/// caches the rendered date prefix per MJD); the time of day is written
+/// from the integral ticks of the datetime. Lines are collected in one,
+/// contiguous buffer, which is written to the file descriptor in large
+/// chunks.
+///
+/// @code
+///   ngpt::epoch_writer<ngpt::milliseconds> w {fileno(stdout)};
+///   w.write(epochs.data(), epochs.data()+epochs.size());
+///   w.flush();
+/// @endcode
+///
+/// @see ngpt::to_chars_ymd_hms
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_BULK_WRITE__
+#define __NGPT_DT_BULK_WRITE__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "dtchars.hpp"
+#include "datetime_format.hpp"
+#include "datetime_rinex.hpp"
+#include "datetime_vector.hpp"
+
+namespace ngpt
+{
+
+/// @brief A buffered writer of datetime sequences to a file descriptor.
+///
+/// Each epoch is written as a date (in one of the ngpt::epoch_layout
+/// layouts), a separator (a blank, or a 'T' for epoch_layout::iso) and a time
+/// of day HH:MM:SS[.f...]. Alternatively, epochs can be written in one of
+/// the (fixed-column) GNSS product file formats (see ngpt::gnss_epoch).
+/// Arbitrary text (e.g. data columns) can be appended via epoch_writer::put.
+///
+/// The writer does not own the file descriptor; it is not closed on
+/// destruction. Any buffered output is flushed on destruction (errors are
+/// ignored at that point; call epoch_writer::flush to detect them).
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class epoch_writer
+{
+public:
+  /// Max number of chars of a date prefix, i.e. a year (of any width, see
+  /// ngpt::dtchars::max_year_width) and up to 8 more chars.
+  static constexpr std::size_t max_date_chars = dtchars::max_year_width + 8;
+
+  /// Max number of chars a single epoch can occupy.
+  static constexpr std::size_t max_epoch_chars = max_date_chars + 18;
+
+  /// @brief Constructor.
+  ///
+  /// @param[in] fd      The (open) file descriptor to write to
+  /// @param[in] layout  Layout of the date part
+  /// @param[in] del     Date delimiter
+  /// @param[in] digits  Number of fractional seconds digits, in [0,9]
+  /// @param[in] bufsize Size of the output buffer (in chars); output is
+  ///                    written to fd when the buffer fills up.
+  /// @throw std::invalid_argument if digits is out of range.
+  explicit
+  epoch_writer(int fd, epoch_layout layout=epoch_layout::ymd, char del='-',
+    int digits=dtchars::sec_digits<S>(), std::size_t bufsize=1<<16)
+    : m_fd{fd},
+      m_layout{layout},
+      m_del{del},
+      m_digits{digits},
+      m_gnss{false},
+      m_gnss_fmt{},
+      m_buf(std::max(bufsize, 4 * max_epoch_chars)),
+      m_size{0},
+      m_mjd{0},
+      m_date_len{0}
+  {
+    if (digits < 0 || digits > 9)
+      throw std::invalid_argument("epoch_writer: invalid number of digits "
+        + std::to_string(digits));
+  }
+
+  /// @brief Constructor for epochs in a GNSS product file format.
+  ///
+  /// @param[in] fd      The (open) file descriptor to write to
+  /// @param[in] format  The epoch format, e.g. gnss_epoch::rinex3_obs
+  /// @param[in] bufsize Size of the output buffer (in chars)
+  explicit
+  epoch_writer(int fd, gnss_epoch format, std::size_t bufsize=1<<16)
+    : m_fd{fd},
+      m_layout{epoch_layout::ymd},
+      m_del{' '},
+      m_digits{0},
+      m_gnss{true},
+      m_gnss_fmt{format},
+      m_buf(std::max(bufsize, 4 * max_epoch_chars)),
+      m_size{0},
+      m_mjd{0},
+      m_date_len{0}
+  {}
+
+  /// Flush any buffered output; the file descriptor is not closed.
+  ~epoch_writer() noexcept
+  {
+    try {
+      flush();
+    } catch (std::runtime_error&) {}
+  }
+
+  epoch_writer(const epoch_writer&) = delete;
+  epoch_writer& operator=(const epoch_writer&) = delete;
+
+  /// @brief Append an epoch (no newline) to the buffer.
+  /// @throw std::runtime_error if the buffer needs to be flushed and writing
+  ///        to the file descriptor fails.
+  void
+  put(const datetime<S>& t)
+  {
+    if (m_buf.size() - m_size < max_epoch_chars) flush();
+    m_size = format(m_buf.data() + m_size, t) - m_buf.data();
+  }
+
+  /// @brief Append n characters to the buffer.
+  /// @throw std::runtime_error if writing to the file descriptor fails.
+  void
+  put(const char* str, std::size_t n)
+  {
+    while (n) {
+      if (m_size == m_buf.size()) flush();
+      const std::size_t k = std::min(n, m_buf.size() - m_size);
+      std::memcpy(m_buf.data() + m_size, str, k);
+      m_size += k;
+      str += k;
+      n -= k;
+    }
+  }
+
+  /// @brief Append a single character to the buffer.
+  /// @throw std::runtime_error if writing to the file descriptor fails.
+  void
+  put(char c)
+  {
+    if (m_size == m_buf.size()) flush();
+    m_buf[m_size++] = c;
+  }
+
+  /// @brief Write a sequence of epochs, one per line.
+  ///
+  /// Each epoch in [first, last) is followed by a newline character.
+  /// @throw std::runtime_error if writing to the file descriptor fails.
+  void
+  write(const datetime<S>* first, const datetime<S>* last)
+  {
+    constexpr std::size_t line = max_epoch_chars + 1;
+    while (first < last) {
+      if (m_buf.size() - m_size < line) flush();
+      // number of lines that surely fit in the buffer
+      std::size_t n = (m_buf.size() - m_size) / line;
+      if (n > static_cast<std::size_t>(last - first)) n = last - first;
+      char* p = m_buf.data() + m_size;
+      for (const datetime<S>* end = first + n; first < end; ++first) {
+        p = format(p, *first);
+        *p++ = '\n';
+      }
+      m_size = p - m_buf.data();
+    }
+  }
+
+  /// @brief Write the epochs of a datetime_vector, one per line.
+  ///
+  /// Same as the datetime array version, but reads the MJD and seconds
+  /// arrays directly.
+  /// @throw std::runtime_error if writing to the file descriptor fails.
+  void
+  write(const datetime_vector<S>& v)
+  {
+    constexpr std::size_t line = max_epoch_chars + 1;
+    const auto* mjd = v.mjd_data();
+    const auto* sec = v.sec_data();
+    std::size_t i = 0;
+    while (i < v.size()) {
+      if (m_buf.size() - m_size < line) flush();
+      std::size_t n = (m_buf.size() - m_size) / line;
+      if (n > v.size() - i) n = v.size() - i;
+      char* p = m_buf.data() + m_size;
+      for (const std::size_t end = i + n; i < end; ++i) {
+        p = format(p, mjd[i], sec[i]);
+        *p++ = '\n';
+      }
+      m_size = p - m_buf.data();
+    }
+  }
+
+  /// @brief Write any buffered output to the file descriptor.
+  /// @throw std::runtime_error if writing to the file descriptor fails.
+  void
+  flush()
+  {
+    const char* p = m_buf.data();
+    std::size_t n = m_size;
+    while (n) {
+      const ssize_t w = ::write(m_fd, p, n);
+      if (w < 0) {
+        if (errno == EINTR) continue;
+        throw std::runtime_error("epoch_writer: failed to write to file "
+          "descriptor: " + std::string(std::strerror(errno)));
+      }
+      p += w;
+      n -= w;
+    }
+    m_size = 0;
+  }
+
+private:
+  /// Render the date prefix (including the date/time separator) of the
+  /// given MJD in m_date.
+  void
+  render_date(modified_julian_day mjd) noexcept
+  {
+    datetime<S> t {mjd, S{0}};
+    char* p = m_date;
+    if (m_gnss) {
+      p = dtchars::write_gnss_date(p, m_gnss_fmt, t.as_ymd());
+      m_date_len = p - m_date;
+      m_mjd = mjd.as_underlying_type();
+      return;
+    }
+    if (m_layout == epoch_layout::ydoy) {
+      const ydoy_date d {t.as_ydoy()};
+      const long y = d.__year.as_underlying_type();
+      p = dtchars::write_year(p, y, dtchars::year_width(y));
+      *p++ = m_del;
+      p = dtchars::write_uint(p, d.__doy.as_underlying_type(), 3);
+    } else {
+      const ymd_date d {t.as_ymd()};
+      const long y = d.__year.as_underlying_type();
+      p = dtchars::write_year(p, y, dtchars::year_width(y));
+      *p++ = m_del;
+      if (m_layout == epoch_layout::yod) {
+        std::memcpy(p, d.__month.short_name(), 3);
+        p += 3;
+      } else {
+        p = dtchars::write_2digits(p, d.__month.as_underlying_type());
+      }
+      *p++ = m_del;
+      p = dtchars::write_2digits(p, d.__dom.as_underlying_type());
+    }
+    *p++ = (m_layout == epoch_layout::iso) ? 'T' : ' ';
+    m_date_len = p - m_date;
+    m_mjd = mjd.as_underlying_type();
+  }
+
+  /// Format an epoch at p (there must be room for max_epoch_chars); return
+  /// one past the last char written.
+  char*
+  format(char* p, const datetime<S>& t) noexcept
+  { return format(p, t.mjd().as_underlying_type(), t.sec_as_i()); }
+
+  /// Format an epoch given as MJD and seconds of day (in ticks of S).
+  char*
+  format(char* p, long mjd, long ticks) noexcept
+  {
+    if (!m_date_len || mjd != m_mjd) render_date(modified_julian_day{mjd});
+    std::memcpy(p, m_date, m_date_len);
+    return m_gnss
+      ? dtchars::write_gnss_time<S>(p + m_date_len, m_gnss_fmt, ticks)
+      : dtchars::write_time<S>(p + m_date_len, ticks, m_digits);
+  }
+
+  int                     m_fd;       ///< the file descriptor
+  epoch_layout            m_layout;   ///< layout of the date part
+  char                    m_del;      ///< date delimiter
+  int                     m_digits;   ///< fractional seconds digits
+  bool                    m_gnss;     ///< write in a GNSS file format ?
+  gnss_epoch              m_gnss_fmt; ///< the GNSS file format
+  std::vector<char>       m_buf;      ///< output buffer
+  std::size_t             m_size;     ///< chars used in the output buffer
+  long                    m_mjd;      ///< MJD of the cached date
+  char                    m_date[max_date_chars]; ///< cached date prefix
+  std::size_t             m_date_len; ///< length of the cached date prefix
+};// epoch_writer
+
+} // namespace ngpt
+
+#endif
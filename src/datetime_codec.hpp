@@ -0,0 +1,330 @@
+///
+/// @file  datetime_codec.hpp
+///
+/// @brief Compression of (regularly sampled) epoch sequences, using a
+///        delta-of-delta encoding (as in Facebook's Gorilla TSDB).
+///
+/// Epochs are handled as ticks of the second type since MJD 0 (see
+/// ngpt::to_linear_ticks). The sequence is split in blocks of a fixed number
+/// of epochs; each block starts (byte-aligned) with the ticks of its first
+/// epoch (64 bits), followed by one variable-length code per epoch, holding
+/// the (zig-zag encoded) difference between consecutive deltas (the delta
+/// before the first epoch of a block is taken as 0):
+/// @code
+///   code                     delta-of-delta (zig-zag)
+///   '0'                      0, i.e. same spacing as before
+///   '10'   + 7 bits          < 2^7
+///   '110'  + 12 bits         < 2^12
+///   '1110' + 20 bits         < 2^20
+///   '1111' + 64 bits         anything else
+/// @endcode
+/// A regularly sampled stream hence costs about one bit per epoch. All bits
+/// are stored most-significant first.
+///
+/// An index holding the first epoch and the byte offset of every block allows
+/// random access (only the block containing an epoch needs to be decoded)
+/// and searching by time. When decoding, runs of '0' codes (i.e. regular
+/// spacing) are resolved up to 64 at a time.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_CODEC__
+#define __NGPT_DT_CODEC__
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_binary.hpp"
+
+namespace ngpt
+{
+
+/// @struct epoch_block_index
+/// An entry of the block index of a ngpt::compressed_epochs sequence.
+struct epoch_block_index
+{
+  std::int64_t first_ticks; ///< ticks (since MJD 0) of the block's first epoch
+  std::size_t  offset;      ///< byte offset of the block in the data
+};// epoch_block_index
+
+namespace dtchars
+{
+
+/// @brief Zig-zag encoding, i.e. map signed integers to unsigned so that
+///        small absolute values give small codes (0,-1,1,-2,... -> 0,1,2,3...)
+constexpr std::uint64_t
+zigzag(std::int64_t v) noexcept
+{
+  return (static_cast<std::uint64_t>(v) << 1)
+    ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+/// @brief Inverse of ngpt::dtchars::zigzag.
+constexpr std::int64_t
+unzigzag(std::uint64_t v) noexcept
+{
+  return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+/// @brief The 64 bits starting at bit position pos (most-significant first);
+///        at least 9 bytes must be available after byte pos/8.
+inline std::uint64_t
+peek_bits(const unsigned char* data, std::size_t pos) noexcept
+{
+  const unsigned char* p = data + (pos >> 3);
+  const int s = static_cast<int>(pos & 7);
+  std::uint64_t w = 0;
+  for (int i = 0; i < 8; i++) w = (w << 8) | p[i];
+  return s ? (w << s) | (p[8] >> (8 - s)) : w;
+}
+
+} // namespace dtchars
+
+/// @brief A compressed sequence of epochs (see the file description).
+///
+/// Epochs are appended (i.e. encoded in a streaming fashion) via
+/// compressed_epochs::push_back; the sequence can be decoded at any time,
+/// in whole or in part.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class compressed_epochs
+{
+public:
+  /// @brief Constructor.
+  /// @param[in] block_size Number of epochs per block; smaller blocks mean
+  ///            faster random access, at the cost of a (slightly) larger
+  ///            size. Must be positive.
+  explicit
+  compressed_epochs(std::size_t block_size=4096)
+    : m_block_size{block_size ? block_size : 1},
+      m_count{0},
+      m_bitpos{0},
+      m_prev_ticks{0},
+      m_prev_delta{0},
+      m_bytes(pad_bytes, 0)
+  {}
+
+  /// @brief Append (encode) an epoch.
+  void
+  push_back(const datetime<S>& t)
+  {
+    const std::int64_t ticks = to_linear_ticks(t);
+    if (!(m_count % m_block_size)) {
+      // start a new block, at a byte boundary
+      m_bitpos = (m_bitpos + 7) & ~static_cast<std::size_t>(7);
+      m_index.push_back({ticks, m_bitpos >> 3});
+      put_bits(static_cast<std::uint64_t>(ticks), 64);
+      m_prev_delta = 0;
+    } else {
+      const std::int64_t delta = ticks - m_prev_ticks;
+      const std::uint64_t zz = dtchars::zigzag(delta - m_prev_delta);
+      if (!zz) {
+        put_bits(0, 1);
+      } else if (zz < (1ULL << 7)) {
+        put_bits((0x2ULL << 7) | zz, 9);
+      } else if (zz < (1ULL << 12)) {
+        put_bits((0x6ULL << 12) | zz, 15);
+      } else if (zz < (1ULL << 20)) {
+        put_bits((0xeULL << 20) | zz, 24);
+      } else {
+        put_bits(0xfULL, 4);
+        put_bits(zz, 64);
+      }
+      m_prev_delta = delta;
+    }
+    m_prev_ticks = ticks;
+    ++m_count;
+  }
+
+  /// Number of epochs.
+  std::size_t
+  size() const noexcept
+  { return m_count; }
+
+  /// Size of the compressed data in bytes.
+  std::size_t
+  bytes() const noexcept
+  { return (m_bitpos + 7) >> 3; }
+
+  /// The compressed data (compressed_epochs::bytes() long).
+  const unsigned char*
+  data() const noexcept
+  { return m_bytes.data(); }
+
+  /// The block index.
+  const std::vector<epoch_block_index>&
+  index() const noexcept
+  { return m_index; }
+
+  /// Number of epochs per block.
+  std::size_t
+  block_size() const noexcept
+  { return m_block_size; }
+
+  /// @brief Decode n epochs (as ticks since MJD 0), starting at epoch first.
+  /// @return The number of epochs decoded (less than n if the sequence ends).
+  std::size_t
+  decode_ticks(std::size_t first, std::size_t n, std::int64_t* out) const
+  noexcept
+  {
+    if (first >= m_count) return 0;
+    n = std::min(n, m_count - first);
+    std::size_t done = 0;
+    std::size_t block = first / m_block_size;
+    std::size_t skip = first % m_block_size;
+    while (done < n) {
+      done += decode_block(block++, skip, n - done, out + done);
+      skip = 0;
+    }
+    return n;
+  }
+
+  /// @brief Decode n epochs, starting at epoch first.
+  /// @return The number of epochs decoded (less than n if the sequence ends).
+  std::size_t
+  decode(std::size_t first, std::size_t n, datetime<S>* out) const
+  {
+    std::int64_t buf[256];
+    std::size_t done = 0;
+    while (done < n) {
+      const std::size_t k = decode_ticks(first + done,
+        std::min<std::size_t>(n - done, 256), buf);
+      if (!k) break;
+      for (std::size_t i = 0; i < k; i++)
+        out[done + i] = from_linear_ticks<S>(buf[i]);
+      done += k;
+    }
+    return done;
+  }
+
+  /// The i-th epoch (no bounds check); only its block is decoded.
+  datetime<S>
+  operator[](std::size_t i) const noexcept
+  {
+    std::int64_t ticks = 0;
+    decode_ticks(i, 1, &ticks);
+    return from_linear_ticks<S>(ticks);
+  }
+
+  /// @brief Index of the first epoch not before t, assuming the sequence is
+  ///        sorted; size() if there is none. The search uses the block index,
+  ///        so that only one block is decoded.
+  std::size_t
+  lower_bound(const datetime<S>& t) const noexcept
+  {
+    const std::int64_t ticks = to_linear_ticks(t);
+    // first block starting at or after t; the answer is either in the block
+    // before it (which may end with epochs equal to t) or its first epoch
+    auto it = std::lower_bound(m_index.cbegin(), m_index.cend(), ticks,
+      [](const epoch_block_index& b, std::int64_t v)
+      { return b.first_ticks < v; });
+    if (it == m_index.cbegin()) return 0;
+    const std::size_t block = (it - m_index.cbegin()) - 1;
+    std::size_t i = block * m_block_size;
+    const std::size_t end = std::min(i + m_block_size, m_count);
+    std::int64_t buf[256];
+    while (i < end) {
+      const std::size_t k = decode_ticks(i, std::min<std::size_t>(256, end-i),
+        buf);
+      for (std::size_t j = 0; j < k; j++)
+        if (buf[j] >= ticks) return i + j;
+      i += k;
+    }
+    return end;
+  }
+
+private:
+  /// Zero bytes kept after the data, so that reads never run past the end.
+  static constexpr std::size_t pad_bytes = 16;
+
+  /// Append the n (<= 64) least significant bits of v.
+  void
+  put_bits(std::uint64_t v, int n)
+  {
+    if (m_bytes.size() < (m_bitpos >> 3) + 8 + pad_bytes)
+      m_bytes.resize(2 * m_bytes.size() + 8 + pad_bytes, 0);
+    while (n > 0) {
+      const int used = static_cast<int>(m_bitpos & 7);
+      const int k = std::min(n, 8 - used);
+      const unsigned chunk = static_cast<unsigned>(v >> (n - k))
+        & ((1U << k) - 1U);
+      m_bytes[m_bitpos >> 3] |= static_cast<unsigned char>(
+        chunk << (8 - used - k));
+      m_bitpos += k;
+      n -= k;
+    }
+  }
+
+  /// Decode n epochs of block b (after skipping the first skip ones);
+  /// returns the number of epochs decoded.
+  std::size_t
+  decode_block(std::size_t b, std::size_t skip, std::size_t n,
+    std::int64_t* out) const noexcept
+  {
+    const unsigned char* buf = m_bytes.data();
+    const std::size_t in_block = std::min(m_block_size,
+                                          m_count - b * m_block_size);
+    const std::size_t end = std::min(in_block, skip + n);
+    std::size_t pos = m_index[b].offset * 8 + 64;
+    std::int64_t ticks = m_index[b].first_ticks;
+    std::int64_t delta = 0;
+    std::size_t i = 0;
+    if (!skip) out[0] = ticks;
+    ++i;
+    while (i < end) {
+      const std::uint64_t w = dtchars::peek_bits(buf, pos);
+      if (!(w >> 63)) {
+        // a run of '0' codes, i.e. same spacing
+        std::size_t run = w ? static_cast<std::size_t>(__builtin_clzll(w))
+                            : 64;
+        run = std::min(run, end - i);
+        for (std::size_t j = 0; j < run; j++, i++) {
+          ticks += delta;
+          if (i >= skip) out[i - skip] = ticks;
+        }
+        pos += run;
+        continue;
+      }
+      std::uint64_t zz;
+      if (!((w >> 62) & 1)) {
+        zz = (w >> 55) & 0x7fULL;
+        pos += 9;
+      } else if (!((w >> 61) & 1)) {
+        zz = (w >> 49) & 0xfffULL;
+        pos += 15;
+      } else if (!((w >> 60) & 1)) {
+        zz = (w >> 40) & 0xfffffULL;
+        pos += 24;
+      } else {
+        zz = dtchars::peek_bits(buf, pos + 4);
+        pos += 68;
+      }
+      delta += dtchars::unzigzag(zz);
+      ticks += delta;
+      if (i >= skip) out[i - skip] = ticks;
+      ++i;
+    }
+    return end - skip;
+  }
+
+  std::size_t                    m_block_size; ///< epochs per block
+  std::size_t                    m_count;      ///< number of epochs
+  std::size_t                    m_bitpos;     ///< bits written
+  std::int64_t                   m_prev_ticks; ///< last epoch encoded
+  std::int64_t                   m_prev_delta; ///< last delta encoded
+  std::vector<unsigned char>     m_bytes;      ///< the data (zero padded)
+  std::vector<epoch_block_index> m_index;      ///< the block index
+};// compressed_epochs
+
+} // namespace ngpt
+
+#endif
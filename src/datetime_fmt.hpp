@@ -0,0 +1,343 @@
+///
+/// @file  datetime_fmt.hpp
+///
+/// @brief Formatter specializations, so that ngpt types can be used with
+///        std::format (C++20) and/or the {fmt} library.
+///
+/// The following types can be formatted:
+/// - ngpt::datetime<S>; the format spec is a ngpt::datetime_format string,
+///   e.g. "{:%Y-%j %H:%M:%S.%6f}". With an empty spec, the epoch is written
+///   as YYYY-MM-DD HH:MM:SS.f (with as many fractional digits as the
+///   precision of S).
+/// - ngpt::ymd_date and ngpt::ydoy_date; the spec is a ngpt::datetime_format
+///   string (default "%Y-%m-%d" and "%Y-%j" respectively).
+/// - ngpt::datetime_interval<S>; written as Dd HH:MM:SS.f (no spec allowed).
+/// - ngpt::modified_julian_day and the second types (ngpt::seconds,
+///   ngpt::milliseconds, ngpt::microseconds); these are formatted as their
+///   underlying integers, i.e. any integer spec (e.g. "{:>8}") can be used.
+///
+/// Formatting writes directly to the output iterator (via a small buffer on
+/// the stack); no std::string is created.
+///
+/// The std::formatter specializations are only available when compiling with
+/// C++20 (or later) and <format> is available; the fmt::formatter ones only
+/// if the {fmt} headers are available (the macro NGPT_HAS_FMT is then
+/// defined). Note that the user is responsible for linking to {fmt}, or
+/// compiling with FMT_HEADER_ONLY.
+///
+/// @code
+///   ngpt::datetime<ngpt::microseconds> t = ...;
+///   fmt::print("epoch: {:%Y-%j %H:%M:%S.%3f}\n", t);
+///   std::string s = std::format("{} (MJD {})", t, t.mjd());
+/// @endcode
+///
+/// @see ngpt::datetime_format
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_FMT__
+#define __NGPT_DT_FMT__
+
+#include <algorithm>
+#include <stdexcept>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "dtchars.hpp"
+#include "datetime_format.hpp"
+#include "datetime_write.hpp"
+
+#if __cplusplus >= 202002L && __has_include(<format>)
+# include <format>
+# ifdef __cpp_lib_format
+#  define NGPT_HAS_STD_FORMAT
+# endif
+#endif
+
+#if __has_include(<fmt/format.h>)
+# include <fmt/format.h>
+# define NGPT_HAS_FMT
+#endif
+
+/// Formatter parse functions can only be constexpr (for compile-time checks
+/// of format strings) in C++20, where try-blocks are allowed there.
+#if __cplusplus >= 202002L
+# define __NGPT_FMT_CONSTEXPR__ constexpr
+#else
+# define __NGPT_FMT_CONSTEXPR__
+#endif
+
+namespace ngpt
+{
+
+/// @brief Format a datetime using a (compiled) format, to an output iterator.
+///
+/// @return Iterator past the last character written.
+/// @throw std::runtime_error if the datetime cannot be formatted.
+template<typename OutputIt, typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  OutputIt
+  format_to(OutputIt out, const datetime_format<>& fmt, const datetime<S>& t)
+{
+  // no instruction writes more than the widest year, so this holds
+  // fmt.max_chars<S>(dtchars::max_year_width) chars for any format
+  char buf[32 * dtchars::max_year_width];
+  auto res = fmt.format(buf, buf + sizeof buf, t);
+  if (res.ec != std::errc{})
+    throw std::runtime_error("format_to: failed to format datetime");
+  return std::copy(buf, res.ptr, out);
+}
+
+/// @brief Format a datetime_interval as Dd HH:MM:SS[.f...] (with as many
+///        fractional digits as the precision of S), to an output iterator.
+///
+/// @return Iterator past the last character written.
+/// @throw std::runtime_error if the interval cannot be formatted.
+template<typename OutputIt, typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  OutputIt
+  format_to(OutputIt out, const datetime_interval<S>& d)
+{
+  // sign, 20 digits of days, "d " and the time
+  char buf[23 + dtchars::time_width(9)];
+  auto res = to_chars_interval(buf, buf + sizeof buf, d);
+  if (res.ec != std::errc{})
+    throw std::runtime_error("format_to: failed to format datetime_interval");
+  return std::copy(buf, res.ptr, out);
+}
+
+namespace dtchars
+{
+
+/// @brief Default format of a datetime<S>, i.e. YYYY-MM-DD HH:MM:SS[.f].
+template<typename S>
+  constexpr const char*
+  default_format(const datetime<S>*) noexcept
+{
+  return sec_digits<S>() ? "%Y-%m-%d %H:%M:%S.%f" : "%Y-%m-%d %H:%M:%S";
+}
+
+/// @brief Default format of a ymd_date.
+constexpr const char*
+default_format(const ymd_date*) noexcept
+{ return "%Y-%m-%d"; }
+
+/// @brief Default format of a ydoy_date.
+constexpr const char*
+default_format(const ydoy_date*) noexcept
+{ return "%Y-%j"; }
+
+/// @brief The datetime to be formatted, for any of the formattable types.
+template<typename S>
+  constexpr const datetime<S>&
+  as_datetime(const datetime<S>& t) noexcept
+{ return t; }
+
+/// @overload
+inline datetime<seconds>
+as_datetime(const ymd_date& d)
+{
+  return datetime<seconds>{cal2mjd(d.__year, d.__month, d.__dom),
+                           seconds{0}};
+}
+
+/// @overload
+inline datetime<seconds>
+as_datetime(const ydoy_date& d) noexcept
+{ return datetime<seconds>{ydoy2mjd(d.__year, d.__doy), seconds{0}}; }
+
+/// @brief Common implementation of the std::formatter and fmt::formatter
+///        specializations for datetime<S>, ymd_date and ydoy_date.
+///
+/// @tparam T     The type to be formatted
+/// @tparam Error The exception type to throw on invalid format specs (i.e.
+///               std::format_error or fmt::format_error)
+template<typename T, typename Error>
+  struct datetime_formatter
+{
+  /// The compiled format (spec); the default one if no spec is given.
+  datetime_format<> m_fmt {default_format(static_cast<const T*>(nullptr))};
+
+  /// Compile the format spec, i.e. everything up to the closing '}'.
+  template<typename ParseContext>
+    __NGPT_FMT_CONSTEXPR__ auto
+    parse(ParseContext& ctx) -> decltype(ctx.begin())
+  {
+    auto it = ctx.begin();
+    char spec[128];
+    std::size_t n = 0;
+    for (; it != ctx.end() && *it != '}'; ++it) {
+      if (n == sizeof spec - 1) throw Error("datetime format spec too long");
+      spec[n++] = *it;
+    }
+    if (n) {
+      spec[n] = '\0';
+      try {
+        m_fmt = datetime_format<>{spec};
+      } catch (std::invalid_argument& e) {
+        throw Error(e.what());
+      }
+    }
+    return it;
+  }
+
+  /// Format the value to the context's output iterator.
+  template<typename FormatContext>
+    auto
+    format(const T& v, FormatContext& ctx) const -> decltype(ctx.out())
+  {
+    try {
+      return ngpt::format_to(ctx.out(), m_fmt, as_datetime(v));
+    } catch (std::runtime_error& e) {
+      throw Error(e.what());
+    }
+  }
+};// datetime_formatter
+
+/// @brief Common implementation of the std::formatter and fmt::formatter
+///        specializations for datetime_interval<S>.
+template<typename T, typename Error>
+  struct interval_formatter
+{
+  /// No format spec is allowed.
+  template<typename ParseContext>
+    constexpr auto
+    parse(ParseContext& ctx) -> decltype(ctx.begin())
+  {
+    auto it = ctx.begin();
+    if (it != ctx.end() && *it != '}')
+      throw Error("datetime_interval does not accept a format spec");
+    return it;
+  }
+
+  /// Format the value to the context's output iterator.
+  template<typename FormatContext>
+    auto
+    format(const T& v, FormatContext& ctx) const -> decltype(ctx.out())
+  {
+    try {
+      return ngpt::format_to(ctx.out(), v);
+    } catch (std::runtime_error& e) {
+      throw Error(e.what());
+    }
+  }
+};// interval_formatter
+
+/// @brief Common implementation of the formatters for the fundamental
+///        (integer-like) types, i.e. modified_julian_day and second types.
+///
+/// @tparam T    The type to be formatted
+/// @tparam Base The (std:: or fmt::) formatter of T's underlying type
+template<typename T, typename Base>
+  struct scalar_formatter : Base
+{
+  /// Format the underlying integer (using the spec parsed by Base).
+  template<typename FormatContext>
+    auto
+    format(const T& v, FormatContext& ctx) const -> decltype(ctx.out())
+  { return Base::format(v.as_underlying_type(), ctx); }
+};// scalar_formatter
+
+} // namespace dtchars
+
+} // namespace ngpt
+
+#ifdef NGPT_HAS_STD_FORMAT
+template<typename S>
+  struct std::formatter<ngpt::datetime<S>, char>
+  : ngpt::dtchars::datetime_formatter<ngpt::datetime<S>, std::format_error>
+{};
+
+template<>
+  struct std::formatter<ngpt::ymd_date, char>
+  : ngpt::dtchars::datetime_formatter<ngpt::ymd_date, std::format_error>
+{};
+
+template<>
+  struct std::formatter<ngpt::ydoy_date, char>
+  : ngpt::dtchars::datetime_formatter<ngpt::ydoy_date, std::format_error>
+{};
+
+template<typename S>
+  struct std::formatter<ngpt::datetime_interval<S>, char>
+  : ngpt::dtchars::interval_formatter<ngpt::datetime_interval<S>,
+                                      std::format_error>
+{};
+
+template<>
+  struct std::formatter<ngpt::modified_julian_day, char>
+  : ngpt::dtchars::scalar_formatter<ngpt::modified_julian_day,
+      std::formatter<ngpt::modified_julian_day::underlying_type, char>>
+{};
+
+template<>
+  struct std::formatter<ngpt::seconds, char>
+  : ngpt::dtchars::scalar_formatter<ngpt::seconds,
+      std::formatter<ngpt::seconds::underlying_type, char>>
+{};
+
+template<>
+  struct std::formatter<ngpt::milliseconds, char>
+  : ngpt::dtchars::scalar_formatter<ngpt::milliseconds,
+      std::formatter<ngpt::milliseconds::underlying_type, char>>
+{};
+
+template<>
+  struct std::formatter<ngpt::microseconds, char>
+  : ngpt::dtchars::scalar_formatter<ngpt::microseconds,
+      std::formatter<ngpt::microseconds::underlying_type, char>>
+{};
+#endif
+
+#ifdef NGPT_HAS_FMT
+template<typename S>
+  struct fmt::formatter<ngpt::datetime<S>>
+  : ngpt::dtchars::datetime_formatter<ngpt::datetime<S>, fmt::format_error>
+{};
+
+template<>
+  struct fmt::formatter<ngpt::ymd_date>
+  : ngpt::dtchars::datetime_formatter<ngpt::ymd_date, fmt::format_error>
+{};
+
+template<>
+  struct fmt::formatter<ngpt::ydoy_date>
+  : ngpt::dtchars::datetime_formatter<ngpt::ydoy_date, fmt::format_error>
+{};
+
+template<typename S>
+  struct fmt::formatter<ngpt::datetime_interval<S>>
+  : ngpt::dtchars::interval_formatter<ngpt::datetime_interval<S>,
+                                      fmt::format_error>
+{};
+
+template<>
+  struct fmt::formatter<ngpt::modified_julian_day>
+  : ngpt::dtchars::scalar_formatter<ngpt::modified_julian_day,
+      fmt::formatter<ngpt::modified_julian_day::underlying_type>>
+{};
+
+template<>
+  struct fmt::formatter<ngpt::seconds>
+  : ngpt::dtchars::scalar_formatter<ngpt::seconds,
+      fmt::formatter<ngpt::seconds::underlying_type>>
+{};
+
+template<>
+  struct fmt::formatter<ngpt::milliseconds>
+  : ngpt::dtchars::scalar_formatter<ngpt::milliseconds,
+      fmt::formatter<ngpt::milliseconds::underlying_type>>
+{};
+
+template<>
+  struct fmt::formatter<ngpt::microseconds>
+  : ngpt::dtchars::scalar_formatter<ngpt::microseconds,
+      fmt::formatter<ngpt::microseconds::underlying_type>>
+{};
+#endif
+
+#endif
@@ -0,0 +1,421 @@
+///
+/// @file  datetime_format.hpp
+///
+/// @brief Compiled (strftime-like) format specifications, used to parse and
+///        format ngpt::datetime objects.
+///
+/// A format string (e.g. "%Y-%m-%d %H:%M:%S.%f") is compiled once, into a
+/// compact "program" (an array of instructions); parsing/formatting is then
+/// performed by executing the program, with no string interpretation at all.
+/// If the format string is a constant expression, the compilation is
+/// performed at compile-time, e.g.
+/// @code
+///   constexpr ngpt::datetime_format<> fmt {"%Y-%m-%d %H:%M:%S.%f"};
+///   ngpt::datetime<ngpt::microseconds> t;
+///   auto res = fmt.parse(str, str+std::strlen(str), t);
+///   if (res.ec != std::errc{}) { /* handle error */ }
+/// @endcode
+///
+/// Parsing and formatting follow the conventions of std::from_chars and
+/// std::to_chars: they do not allocate, do not throw and report errors via
+/// an std::errc code.
+///
+/// @see ngpt::datetime
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_FORMAT__
+#define __NGPT_DT_FORMAT__
+
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+#include <stdexcept>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "dtchars.hpp"
+
+namespace ngpt
+{
+
+/// @enum epoch_layout
+/// Layouts of epoch strings (only the date part is described here).
+enum class epoch_layout
+: char
+{
+  ymd,  ///< year, month, day of month, e.g. 2015-12-30
+  ydoy, ///< year, day of year, e.g. 2015-364
+  yod,  ///< year, month name, day of month, e.g. 2015 Dec 30
+  iso   ///< year, month, day of month with a 'T' separator, e.g 2015-12-30T12
+};// epoch_layout
+
+/// @enum fmt_op
+/// Instructions (opcodes) of a compiled datetime format.
+enum class fmt_op
+: unsigned char
+{
+  literal,      ///< literal character; whitespace matches any run of blanks
+  year,         ///< %Y year, 4 digits
+  month,        ///< %m month, 2 digits
+  month_name,   ///< %b month, 3-char name (when parsing, long names also work)
+  day_of_month, ///< %d day of month, 2 digits
+  day_of_year,  ///< %j day of year, 3 digits
+  hours,        ///< %H hours, 2 digits
+  minutes,      ///< %M minutes, 2 digits
+  seconds,      ///< %S (integer) seconds, 2 digits
+  fraction      ///< %f or %Nf fractional seconds (N digits)
+};// fmt_op
+
+/// @struct fmt_instr
+/// A single instruction of a compiled datetime format.
+struct fmt_instr
+{
+  fmt_op        op;     ///< the opcode
+  char          chr;    ///< the character to match/write (for literals)
+  unsigned char width;  ///< field width in chars (or fractional digits)
+};// fmt_instr
+
+/// @brief Index of a field in an array of resolved datetime fields.
+///
+/// Parsers resolve the datetime fields in an array of 8 long integers, in the
+/// order: year, month, day of month, day of year, hours, minutes, seconds and
+/// fractional seconds (in ticks of the second type).
+constexpr int
+fmt_field_index(fmt_op op) noexcept
+{
+  switch (op) {
+    case fmt_op::year:         return 0;
+    case fmt_op::month:
+    case fmt_op::month_name:   return 1;
+    case fmt_op::day_of_month: return 2;
+    case fmt_op::day_of_year:  return 3;
+    case fmt_op::hours:        return 4;
+    case fmt_op::minutes:      return 5;
+    case fmt_op::seconds:      return 6;
+    default:                   return 7;
+  }
+}
+
+namespace dtchars
+{
+
+/// @brief Resolve a month name (short or long, case-insensitive).
+/// @return Pointer to the first char not interpreted or nullptr on error.
+inline const char*
+parse_month_name(const char* first, const char* last, long& mnt) noexcept
+{
+  const char* p = first;
+  while (p < last && is_alpha(*p)) ++p;
+  const month::underlying_type m = month_from_str(first, p - first);
+  if (!m) return nullptr;
+  mnt = m;
+  return p;
+}
+
+/// @brief Validate an array of resolved fields and assemble a datetime.
+///
+/// @param[in]  fields  The resolved fields (see ngpt::fmt_field_index); the
+///                     fractional seconds are expected in ticks of S.
+/// @param[in]  use_doy If true, the date is year/day-of-year, else it is
+///                     year/month/day-of-month.
+/// @param[out] t       The resulting datetime; only changed on success.
+/// @return             std::errc{} on success, or
+///                     std::errc::result_out_of_range if any of the fields
+///                     is out of its valid range.
+template<typename S>
+  std::errc
+  assemble_datetime(const long* fields, bool use_doy, datetime<S>& t) noexcept
+{
+  year y {static_cast<year::underlying_type>(fields[0])};
+  modified_julian_day mjd;
+  if (use_doy) {
+    day_of_year doy {static_cast<day_of_year::underlying_type>(fields[3])};
+    if (!doy.is_valid(y)) return std::errc::result_out_of_range;
+    mjd = ydoy2mjd(y, doy);
+  } else {
+    ymd_date ymd {y, month{static_cast<month::underlying_type>(fields[1])},
+      day_of_month{static_cast<day_of_month::underlying_type>(fields[2])}};
+    if (!ymd.is_valid()) return std::errc::result_out_of_range;
+    mjd = cal2mjd(ymd.__year, ymd.__month, ymd.__dom);
+  }
+  if (fields[4] > 23 || fields[5] > 59 || fields[6] > 60)
+    return std::errc::result_out_of_range;
+
+  typename S::underlying_type ticks = ((fields[4] * 60L + fields[5]) * 60L
+    + fields[6]) * S::template sec_factor<long>() + fields[7];
+  t = datetime<S>{mjd, S{ticks}};
+  return std::errc{};
+}
+
+} // namespace dtchars
+
+/// @brief A compiled datetime format specification.
+///
+/// The format string is made up of literal characters and of the following
+/// conversion specifiers:
+/// - %Y year (4 digits)
+/// - %m month (2 digits)
+/// - %b month as 3-char name, e.g. "Jan" (case-insensitive when parsing)
+/// - %d day of month (2 digits)
+/// - %j day of year (3 digits)
+/// - %H hours (2 digits)
+/// - %M minutes (2 digits)
+/// - %S integer seconds (2 digits)
+/// - %f fractional seconds, with as many digits as the precision of the
+///   second type used; %Nf (N in [1,9]) forces N digits.
+/// - %% a literal '%'
+///
+/// When parsing, numeric fields can have less digits than their nominal
+/// width (e.g. "2015-1-3" is fine for "%Y-%m-%d"), a whitespace character in
+/// the format matches any run (even empty) of blanks and %f consumes all
+/// digits available, truncating to the precision of the datetime.
+///
+/// @tparam N Maximum number of instructions (i.e. size of the program).
+///
+/// @throw The constructor throws an std::invalid_argument if the format
+///        string is invalid; in a constexpr context, this results in a
+///        compilation error.
+template<std::size_t N = 32>
+  class datetime_format
+{
+public:
+  /// Compile a format string.
+  explicit constexpr
+  datetime_format(const char* fmt)
+    : m_prog{},
+      m_size{0},
+      m_fields{0}
+  {
+    for (const char* c = fmt; *c; ++c) {
+      if (m_size >= N)
+        throw std::invalid_argument("datetime_format: format too long");
+      fmt_instr& ins = m_prog[m_size++];
+      ins = fmt_instr{fmt_op::literal, *c, 1};
+      if (*c != '%') continue;
+      ++c;
+      if (*c >= '1' && *c <= '9') {
+        ins.width = static_cast<unsigned char>(*c++ - '0');
+        if (*c != 'f')
+          throw std::invalid_argument("datetime_format: invalid width");
+      }
+      switch (*c) {
+        case '%': break;
+        case 'Y': ins = fmt_instr{fmt_op::year, 0, 4}; break;
+        case 'm': ins = fmt_instr{fmt_op::month, 0, 2}; break;
+        case 'b': ins = fmt_instr{fmt_op::month_name, 0, 3}; break;
+        case 'd': ins = fmt_instr{fmt_op::day_of_month, 0, 2}; break;
+        case 'j': ins = fmt_instr{fmt_op::day_of_year, 0, 3}; break;
+        case 'H': ins = fmt_instr{fmt_op::hours, 0, 2}; break;
+        case 'M': ins = fmt_instr{fmt_op::minutes, 0, 2}; break;
+        case 'S': ins = fmt_instr{fmt_op::seconds, 0, 2}; break;
+        case 'f':
+          // width 1 without a digit means 'native', mark it with 0
+          ins = fmt_instr{fmt_op::fraction, 0,
+            static_cast<unsigned char>(c[-1] == '%' ? 0 : ins.width)};
+          break;
+        default:
+          throw std::invalid_argument("datetime_format: invalid specifier");
+      }
+      m_fields |= field_bit(ins.op);
+    }
+    if ((m_fields & field_bit(fmt_op::day_of_year))
+     && (m_fields & (field_bit(fmt_op::month)|field_bit(fmt_op::month_name))))
+      throw std::invalid_argument("datetime_format: both month and doy");
+  }
+
+  /// Number of instructions in the compiled program.
+  constexpr std::size_t
+  size() const noexcept
+  { return m_size; }
+
+  /// The i-th instruction of the compiled program.
+  constexpr fmt_instr
+  operator[](std::size_t i) const noexcept
+  { return m_prog[i]; }
+
+  /// Does the format (fully) describe a date, i.e. can it be used to parse
+  /// datetime instances?
+  constexpr bool
+  has_date() const noexcept
+  {
+    return (m_fields & field_bit(fmt_op::year))
+        && ((m_fields & field_bit(fmt_op::day_of_year))
+        || ((m_fields & (field_bit(fmt_op::month)|field_bit(fmt_op::month_name)))
+        && (m_fields & field_bit(fmt_op::day_of_month))));
+  }
+
+  /// @brief Maximum number of characters a formatted datetime can occupy,
+  ///        when years are written with ywidth characters (see
+  ///        ngpt::dtchars::year_width); the default covers years in the
+  ///        range [0,9999], and ngpt::dtchars::max_year_width any year.
+  template<typename S>
+    constexpr std::size_t
+    max_chars(int ywidth = 4) const noexcept
+  {
+    std::size_t sz = 0;
+    for (std::size_t i = 0; i < m_size; i++)
+      sz += (m_prog[i].op == fmt_op::fraction)
+          ? fraction_digits<S>(m_prog[i])
+          : (m_prog[i].op == fmt_op::year)
+          ? static_cast<std::size_t>(ywidth) : m_prog[i].width;
+    return sz;
+  }
+
+  /// @brief Parse a datetime from the character range [first, last).
+  ///
+  /// @param[in]  first Start of the character range
+  /// @param[in]  last  End of the character range (one past the last char)
+  /// @param[out] t     The resolved datetime; only changed on success.
+  /// @return           An std::from_chars_result; on success, ec is
+  ///                   value-initialized and ptr points to the first
+  ///                   character not interpreted. On failure, ptr points to
+  ///                   the character where the error was detected and ec is
+  ///                   std::errc::invalid_argument if the string does not
+  ///                   match the format, or std::errc::result_out_of_range
+  ///                   if a field is out of its valid range (e.g. month 13).
+  template<typename S,
+          typename = std::enable_if_t<S::is_of_sec_type>
+          >
+    std::from_chars_result
+    parse(const char* first, const char* last, datetime<S>& t) const noexcept
+  {
+    constexpr int sdigits = dtchars::sec_digits<S>();
+    long fields[8] = {0, 1, 1, 1, 0, 0, 0, 0}; // see ngpt::fmt_field_index
+    const char* p = first;
+    if (!has_date()) return {p, std::errc::invalid_argument};
+
+    for (std::size_t i = 0; i < m_size; i++) {
+      const fmt_instr ins = m_prog[i];
+      const char* q = nullptr;
+      switch (ins.op) {
+        case fmt_op::literal:
+          if (dtchars::is_blank(ins.chr)) {
+            while (p < last && dtchars::is_blank(*p)) ++p;
+            continue;
+          }
+          if (p >= last || *p != ins.chr) return {p, std::errc::invalid_argument};
+          ++p;
+          continue;
+        case fmt_op::month_name:
+          q = dtchars::parse_month_name(p, last, fields[1]);
+          break;
+        case fmt_op::fraction:
+          q = dtchars::parse_fraction(p, last, sdigits, fields[7]);
+          break;
+        default:
+          q = dtchars::parse_uint(p, last, ins.width,
+                                  fields[fmt_field_index(ins.op)]);
+      }
+      if (!q) return {p, std::errc::invalid_argument};
+      p = q;
+    }
+
+    const std::errc ec = dtchars::assemble_datetime(fields,
+      m_fields & field_bit(fmt_op::day_of_year), t);
+    return {p, ec};
+  }
+
+  /// @brief Format a datetime into the character range [first, last).
+  ///
+  /// @param[in] first Start of the (output) character range
+  /// @param[in] last  End of the character range (one past the last char)
+  /// @param[in] t     The datetime to format; expected to be normalized.
+  /// @return          An std::to_chars_result; on success, ec is
+  ///                  value-initialized and ptr is the one-past-the-end
+  ///                  pointer of the characters written. On failure (the
+  ///                  range is too small) ptr is last and ec is
+  ///                  std::errc::value_too_large; the contents of the range
+  ///                  are then unspecified. No null character is written.
+  template<typename S,
+          typename = std::enable_if_t<S::is_of_sec_type>
+          >
+    std::to_chars_result
+    format(char* first, char* last, const datetime<S>& t) const noexcept
+  {
+    long ymd[3] = {0, 0, 0}, doy = 0;
+    if (m_fields & field_bit(fmt_op::day_of_year)) {
+      ydoy_date yd {t.as_ydoy()};
+      ymd[0] = yd.__year.as_underlying_type();
+      doy    = yd.__doy.as_underlying_type();
+    } else if (m_fields & (field_bit(fmt_op::year)|field_bit(fmt_op::month)
+      |field_bit(fmt_op::month_name)|field_bit(fmt_op::day_of_month))) {
+      ymd_date yd {t.as_ymd()};
+      ymd[0] = yd.__year.as_underlying_type();
+      ymd[1] = yd.__month.as_underlying_type();
+      ymd[2] = yd.__dom.as_underlying_type();
+    }
+    // years with more than 4 digits (or a sign) need some extra room, for
+    // every year instruction
+    const int ywidth = dtchars::year_width(ymd[0]);
+    if (static_cast<std::size_t>(last - first) < max_chars<S>(ywidth))
+      return {last, std::errc::value_too_large};
+
+    constexpr long factor = S::template sec_factor<long>();
+    const long tsec = t.sec_as_i() / factor;
+    const long frac = t.sec_as_i() % factor;
+
+    char* p = first;
+    for (std::size_t i = 0; i < m_size; i++) {
+      const fmt_instr ins = m_prog[i];
+      switch (ins.op) {
+        case fmt_op::literal:
+          *p++ = ins.chr;
+          break;
+        case fmt_op::year:
+          p = dtchars::write_year(p, ymd[0], ywidth);
+          break;
+        case fmt_op::month:
+          p = dtchars::write_2digits(p, ymd[1]);
+          break;
+        case fmt_op::month_name: {
+          const char* name = month{static_cast<int>(ymd[1])}.short_name();
+          for (int j = 0; j < 3; j++) *p++ = name[j];
+          break;
+        }
+        case fmt_op::day_of_month:
+          p = dtchars::write_2digits(p, ymd[2]);
+          break;
+        case fmt_op::day_of_year:
+          p = dtchars::write_uint(p, doy, 3);
+          break;
+        case fmt_op::hours:
+          p = dtchars::write_2digits(p, tsec / 3600L);
+          break;
+        case fmt_op::minutes:
+          p = dtchars::write_2digits(p, (tsec % 3600L) / 60L);
+          break;
+        case fmt_op::seconds:
+          p = dtchars::write_2digits(p, tsec % 60L);
+          break;
+        case fmt_op::fraction:
+          p = dtchars::write_fraction(p, frac, dtchars::sec_digits<S>(),
+                                      fraction_digits<S>(ins));
+          break;
+      }
+    }
+    return {p, std::errc{}};
+  }
+
+private:
+  /// Bit (in m_fields) marking that the format includes the given field.
+  static constexpr unsigned
+  field_bit(fmt_op op) noexcept
+  { return 1U << static_cast<unsigned>(op); }
+
+  /// Number of fractional digits written for a fraction instruction.
+  template<typename S>
+    static constexpr int
+    fraction_digits(fmt_instr ins) noexcept
+  { return ins.width ? ins.width : dtchars::sec_digits<S>(); }
+
+  fmt_instr m_prog[N]; ///< the compiled program
+  std::size_t m_size;  ///< number of instructions in m_prog
+  unsigned m_fields;   ///< bit-set of the fields included in the format
+};// datetime_format
+
+} // namespace ngpt
+
+#endif
@@ -0,0 +1,300 @@
+///
+/// @file  datetime_hash.hpp
+///
+/// @brief std::hash specializations for ngpt::modified_julian_day, the
+///        second types and ngpt::datetime, and an open-addressing hash map
+///        keyed by epochs.
+///
+/// All hashes feed the underlying integer (for a datetime, its linear ticks,
+/// see ngpt::to_linear_ticks) through the SplitMix64 finalizer, so that
+/// consecutive keys are spread over all bits (std::hash<long> is the
+/// identity in libstdc++, which interacts badly with power-of-2 tables).
+///
+/// ngpt::epoch_map exploits the fact that epoch keys are (nearly) arithmetic
+/// progressions: the slot of a key is found by Fibonacci hashing (one
+/// multiplication by 2^64/phi and a shift), which maps any arithmetic
+/// progression to (nearly) evenly spaced slots, so that collisions are rare
+/// and linear probing stays short. Keys and values are stored together in a
+/// single, flat array.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_HASH__
+#define __NGPT_DT_HASH__
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_binary.hpp"
+
+namespace ngpt
+{
+
+namespace dtchars
+{
+
+/// @brief The SplitMix64 finalizer (a bijective, avalanching mix of the bits
+///        of x).
+constexpr std::uint64_t
+hash_mix(std::uint64_t x) noexcept
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+/// @brief Hash of any type with an as_underlying_type() member.
+template<typename T>
+  struct underlying_hash
+{
+  std::size_t
+  operator()(const T& t) const noexcept
+  {
+    return static_cast<std::size_t>(hash_mix(static_cast<std::uint64_t>(
+      static_cast<std::int64_t>(t.as_underlying_type()))));
+  }
+};// underlying_hash
+
+} // namespace dtchars
+
+/// @brief An open-addressing hash map from epochs (datetime<S>) to values of
+///        type V (see the file description).
+///
+/// The table size is a power of 2 and is doubled when more than 3/4 of the
+/// slots are used; erasure uses backward-shift deletion (no tombstones).
+/// Pointers to values are invalidated by insertions and erasures.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+/// @tparam V The type of the values (must be default-constructible).
+template<typename S, typename V,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class epoch_map
+{
+public:
+  /// An empty map.
+  epoch_map()
+  { rehash(16); }
+
+  /// An empty map with room for n keys (without rehashing).
+  explicit
+  epoch_map(std::size_t n)
+  { reserve(n); }
+
+  /// @brief Insert a (key, value) pair, if the key is not already present.
+  /// @return A pointer to the value of the key, and whether it was inserted.
+  std::pair<V*, bool>
+  insert(const datetime<S>& t, const V& value)
+  {
+    const std::int64_t key = to_linear_ticks(t);
+    if ((m_size + 1) * 4 > m_slots.size() * 3) rehash(m_slots.size() * 2);
+    std::size_t i = home(key);
+    for (; m_slots[i].key != empty_key; i = (i + 1) & m_mask)
+      if (m_slots[i].key == key) return {&m_slots[i].value, false};
+    m_slots[i].key = key;
+    m_slots[i].value = value;
+    ++m_size;
+    return {&m_slots[i].value, true};
+  }
+
+  /// The value of a key, inserted (default-constructed) if not present.
+  V&
+  operator[](const datetime<S>& t)
+  { return *insert(t, V{}).first; }
+
+  /// The value of a key, or nullptr if not present.
+  V*
+  find(const datetime<S>& t) noexcept
+  {
+    const std::size_t i = locate(to_linear_ticks(t));
+    return (i == npos) ? nullptr : &m_slots[i].value;
+  }
+
+  /// The value of a key, or nullptr if not present.
+  const V*
+  find(const datetime<S>& t) const noexcept
+  {
+    const std::size_t i = locate(to_linear_ticks(t));
+    return (i == npos) ? nullptr : &m_slots[i].value;
+  }
+
+  /// Is the key present?
+  bool
+  contains(const datetime<S>& t) const noexcept
+  { return locate(to_linear_ticks(t)) != npos; }
+
+  /// @brief Remove a key.
+  /// @return false if the key was not present.
+  bool
+  erase(const datetime<S>& t) noexcept
+  {
+    std::size_t i = locate(to_linear_ticks(t));
+    if (i == npos) return false;
+    // shift back the following keys of the cluster that can move to the hole
+    for (std::size_t j = (i + 1) & m_mask; m_slots[j].key != empty_key;
+      j = (j + 1) & m_mask) {
+      const std::size_t h = home(m_slots[j].key);
+      if (((j - h) & m_mask) >= ((j - i) & m_mask)) {
+        m_slots[i] = std::move(m_slots[j]);
+        i = j;
+      }
+    }
+    m_slots[i].key = empty_key;
+    m_slots[i].value = V{};
+    --m_size;
+    return true;
+  }
+
+  /// Call f(epoch, value) for all pairs (in no particular order).
+  template<typename F>
+    void
+    for_each(F f) const
+  {
+    for (const auto& s : m_slots)
+      if (s.key != empty_key) f(from_linear_ticks<S>(s.key), s.value);
+  }
+
+  /// Number of keys.
+  std::size_t
+  size() const noexcept
+  { return m_size; }
+
+  /// Is the map empty?
+  bool
+  empty() const noexcept
+  { return !m_size; }
+
+  /// Make room for n keys (without rehashing).
+  void
+  reserve(std::size_t n)
+  {
+    std::size_t c = 16;
+    while (c * 3 < n * 4) c <<= 1;
+    if (m_slots.empty() || c > m_slots.size()) rehash(c);
+  }
+
+  /// Remove all keys.
+  void
+  clear()
+  {
+    for (auto& s : m_slots) s = slot{};
+    m_size = 0;
+  }
+
+private:
+  /// Marks an empty slot (not the ticks of any valid epoch).
+  static constexpr std::int64_t empty_key =
+    std::numeric_limits<std::int64_t>::min();
+  /// Returned by locate when a key is not present.
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  /// A key (in ticks) and its value.
+  struct slot
+  {
+    std::int64_t key = empty_key;
+    V            value {};
+  };
+
+  /// Home slot of a key (Fibonacci hashing).
+  std::size_t
+  home(std::int64_t key) const noexcept
+  {
+    return static_cast<std::size_t>((static_cast<std::uint64_t>(key)
+      * 0x9e3779b97f4a7c15ULL) >> m_shift);
+  }
+
+  /// Slot holding a key, or npos.
+  std::size_t
+  locate(std::int64_t key) const noexcept
+  {
+    for (std::size_t i = home(key); m_slots[i].key != empty_key;
+      i = (i + 1) & m_mask)
+      if (m_slots[i].key == key) return i;
+    return npos;
+  }
+
+  /// Move all pairs to a table of c (a power of 2) slots.
+  void
+  rehash(std::size_t c)
+  {
+    std::vector<slot> old (c);
+    old.swap(m_slots);
+    m_mask = c - 1;
+    m_shift = 64;
+    for (std::size_t k = c; k > 1; k >>= 1) --m_shift;
+    for (auto& s : old) {
+      if (s.key == empty_key) continue;
+      std::size_t i = home(s.key);
+      while (m_slots[i].key != empty_key) i = (i + 1) & m_mask;
+      m_slots[i] = std::move(s);
+    }
+  }
+
+  std::vector<slot> m_slots;     ///< the table
+  std::size_t       m_size  = 0; ///< number of keys
+  std::size_t       m_mask  = 0; ///< table size - 1
+  unsigned          m_shift = 0; ///< 64 - log2(table size)
+};// epoch_map
+
+} // namespace ngpt
+
+namespace std
+{
+
+template<>
+  struct hash<ngpt::modified_julian_day>
+  : ngpt::dtchars::underlying_hash<ngpt::modified_julian_day>
+{};
+
+template<>
+  struct hash<ngpt::hours>
+  : ngpt::dtchars::underlying_hash<ngpt::hours>
+{};
+
+template<>
+  struct hash<ngpt::minutes>
+  : ngpt::dtchars::underlying_hash<ngpt::minutes>
+{};
+
+template<>
+  struct hash<ngpt::seconds>
+  : ngpt::dtchars::underlying_hash<ngpt::seconds>
+{};
+
+template<>
+  struct hash<ngpt::milliseconds>
+  : ngpt::dtchars::underlying_hash<ngpt::milliseconds>
+{};
+
+template<>
+  struct hash<ngpt::microseconds>
+  : ngpt::dtchars::underlying_hash<ngpt::microseconds>
+{};
+
+/// Hash of a datetime, i.e. of its linear ticks.
+template<typename S>
+  struct hash<ngpt::datetime<S>>
+{
+  std::size_t
+  operator()(const ngpt::datetime<S>& t) const noexcept
+  {
+    return static_cast<std::size_t>(ngpt::dtchars::hash_mix(
+      static_cast<std::uint64_t>(ngpt::to_linear_ticks(t))));
+  }
+};
+
+} // namespace std
+
+#endif
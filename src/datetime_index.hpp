@@ -0,0 +1,248 @@
+///
+/// @file  datetime_index.hpp
+///
+/// @brief A search index over a sorted array of epochs, for fast floor, ceil
+///        and nearest-epoch queries.
+///
+/// Epochs are stored as (single int64) linear ticks (see
+/// ngpt::to_linear_ticks), so that every comparison is a single integer
+/// comparison instead of a (day, seconds) pair. The keys are laid out in
+/// Eytzinger (i.e. BFS, heap-like) order: the root at index 1, the children
+/// of node k at 2k and 2k+1. The tree is padded to a complete one, so the
+/// keys are a single packed array and the result of a search follows from
+/// the leaf it ends at (no per-node positions are stored). A search walks
+/// down the tree with no branches (the next node is computed from the
+/// result of the comparison), a fixed number of steps, and the first levels
+/// of the tree stay in cache. The
+/// nodes a few levels down the search path are contiguous, so they are
+/// prefetched while the current level is compared.
+///
+/// The batched queries interleave the searches of a group of epochs, level
+/// by level, so that the (prefetched) memory accesses of different queries
+/// overlap.
+///
+/// All query results are positions in the (sorted) input array, or
+/// epoch_index::npos if there is no such epoch.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_INDEX__
+#define __NGPT_DT_INDEX__
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_binary.hpp"
+
+namespace ngpt
+{
+
+/// @brief A search index over a sorted array of epochs (see the file
+///        description).
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class epoch_index
+{
+public:
+  /// Returned by queries with no result.
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  /// @brief Build the index of n epochs.
+  /// @throw std::invalid_argument if the epochs are not sorted (duplicates
+  ///        are allowed).
+  epoch_index(const datetime<S>* epochs, std::size_t n)
+    : m_sorted(n),
+      m_depth{0}
+  {
+    for (std::size_t i = 0; i < n; i++) {
+      m_sorted[i] = to_linear_ticks(epochs[i]);
+      if (i && m_sorted[i] < m_sorted[i-1])
+        throw std::invalid_argument("epoch_index: epochs are not sorted");
+    }
+    while ((std::size_t{1} << m_depth) - 1 < n) ++m_depth;
+    const std::size_t nodes = (std::size_t{1} << m_depth) - 1;
+    m_keys.resize(nodes + 1);
+    m_keys[0] = std::numeric_limits<std::int64_t>::max();
+    std::size_t i = 0;
+    build(1, nodes, i);
+  }
+
+  /// Number of epochs.
+  std::size_t
+  size() const noexcept
+  { return m_sorted.size(); }
+
+  /// The i-th epoch (in sorted order; no bounds check).
+  datetime<S>
+  operator[](std::size_t i) const noexcept
+  { return from_linear_ticks<S>(m_sorted[i]); }
+
+  /// The i-th epoch as ticks of S since MJD 0 (no bounds check).
+  std::int64_t
+  ticks(std::size_t i) const noexcept
+  { return m_sorted[i]; }
+
+  /// Position of the first epoch not before t (npos if none).
+  std::size_t
+  ceil(const datetime<S>& t) const noexcept
+  { return result(search<false>(to_linear_ticks(t))); }
+
+  /// Position of the last epoch not after t (npos if none).
+  std::size_t
+  floor(const datetime<S>& t) const noexcept
+  { return search<true>(to_linear_ticks(t)) - 1; }
+
+  /// Position of the epoch closest to t (the earlier one on ties; npos only
+  /// if the index is empty).
+  std::size_t
+  nearest(const datetime<S>& t) const noexcept
+  {
+    const std::int64_t x = to_linear_ticks(t);
+    return closest(x, search<false>(x));
+  }
+
+  /// Position of the epoch closest to t, provided it is at most tol away
+  /// (else npos).
+  std::size_t
+  within(const datetime<S>& t, S tol) const noexcept
+  {
+    const std::int64_t x = to_linear_ticks(t);
+    const std::size_t i = closest(x, search<false>(x));
+    if (i == npos) return npos;
+    const std::int64_t d = m_sorted[i] - x;
+    return (d <= tol.as_underlying_type() && -d <= tol.as_underlying_type())
+      ? i : npos;
+  }
+
+  /// Batched ngpt::epoch_index::ceil, for n epochs.
+  void
+  ceil(const datetime<S>* t, std::size_t n, std::size_t* out) const noexcept
+  {
+    search_batch<false>(t, n, out);
+    for (std::size_t i = 0; i < n; i++) out[i] = result(out[i]);
+  }
+
+  /// Batched ngpt::epoch_index::floor, for n epochs.
+  void
+  floor(const datetime<S>* t, std::size_t n, std::size_t* out) const noexcept
+  {
+    search_batch<true>(t, n, out);
+    for (std::size_t i = 0; i < n; i++) out[i] -= 1;
+  }
+
+  /// Batched ngpt::epoch_index::nearest, for n epochs.
+  void
+  nearest(const datetime<S>* t, std::size_t n, std::size_t* out) const
+  noexcept
+  {
+    search_batch<false>(t, n, out);
+    for (std::size_t i = 0; i < n; i++)
+      out[i] = closest(to_linear_ticks(t[i]), out[i]);
+  }
+
+private:
+  /// Number of queries interleaved in batched searches.
+  static constexpr std::size_t batch = 8;
+
+  /// Fill in the (sub)tree rooted at node k (in-order, i.e. sorted); nodes
+  /// past the last epoch hold the maximum key.
+  void
+  build(std::size_t k, std::size_t nodes, std::size_t& i) noexcept
+  {
+    if (k > nodes) return;
+    build(2 * k, nodes, i);
+    const std::size_t n = m_sorted.size();
+    m_keys[k] = (i < n) ? m_sorted[i]
+                        : std::numeric_limits<std::int64_t>::max();
+    ++i;
+    build(2 * k + 1, nodes, i);
+  }
+
+  /// A position or npos, from a rank in [0, size()].
+  std::size_t
+  result(std::size_t r) const noexcept
+  { return r < m_sorted.size() ? r : npos; }
+
+  /// Position of the closest of the epochs at r-1 and r (r as returned by
+  /// search<false>, i.e. the lower bound of x).
+  std::size_t
+  closest(std::int64_t x, std::size_t r) const noexcept
+  {
+    const std::size_t n = m_sorted.size();
+    if (!n) return npos;
+    if (r == n) return n - 1;
+    if (!r) return 0;
+    return (x - m_sorted[r-1] <= m_sorted[r] - x) ? r - 1 : r;
+  }
+
+  /// Node reached after one step down from k.
+  template<bool Upper>
+    std::size_t
+    step(std::size_t k, std::int64_t x) const noexcept
+  {
+    __builtin_prefetch(m_keys.data() + 8 * k);
+    return 2 * k + (Upper ? m_keys[k] <= x : m_keys[k] < x);
+  }
+
+  /// Rank (in [0, size()]) of the result of a search ending at leaf k: the
+  /// leaves of the complete tree, left to right, are the gaps before each
+  /// in-order key, so the leaf's offset is the number of keys passed.
+  std::size_t
+  rank(std::size_t k) const noexcept
+  {
+    const std::size_t r = k - (std::size_t{1} << m_depth);
+    return r < m_sorted.size() ? r : m_sorted.size();
+  }
+
+  /// Rank (in [0, size()]) of the first epoch not before x (or, if Upper is
+  /// true, after x).
+  template<bool Upper>
+    std::size_t
+    search(std::int64_t x) const noexcept
+  {
+    std::size_t k = 1;
+    for (int l = 0; l < m_depth; l++) k = step<Upper>(k, x);
+    return rank(k);
+  }
+
+  /// search() for n epochs, interleaving groups of queries.
+  template<bool Upper>
+    void
+    search_batch(const datetime<S>* t, std::size_t n, std::size_t* out) const
+    noexcept
+  {
+    std::size_t i = 0;
+    for (; i + batch <= n; i += batch) {
+      std::int64_t x[batch];
+      std::size_t  k[batch];
+      for (std::size_t j = 0; j < batch; j++) {
+        x[j] = to_linear_ticks(t[i+j]);
+        k[j] = 1;
+      }
+      for (int l = 0; l < m_depth; l++)
+        for (std::size_t j = 0; j < batch; j++) k[j] = step<Upper>(k[j], x[j]);
+      for (std::size_t j = 0; j < batch; j++)
+        out[i+j] = rank(k[j]);
+    }
+    for (; i < n; i++) out[i] = search<Upper>(to_linear_ticks(t[i]));
+  }
+
+  std::vector<std::int64_t> m_sorted; ///< the epochs (ticks), sorted
+  std::vector<std::int64_t> m_keys;   ///< the epochs in Eytzinger order
+  int                       m_depth;  ///< depth of the (complete) tree
+};// epoch_index
+
+} // namespace ngpt
+
+#endif
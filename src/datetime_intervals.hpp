@@ -0,0 +1,361 @@
+///
+/// @file  datetime_intervals.hpp
+///
+/// @brief Sets of time windows, i.e. [start, stop) epoch intervals (e.g.
+///        satellite visibility windows, data outages or maneuver periods),
+///        and an interval tree for stabbing (and overlap) queries.
+///
+/// Windows are stored as pairs of linear ticks (see ngpt::to_linear_ticks)
+/// in flat, contiguous arrays:
+/// - an ngpt::interval_set holds sorted, disjoint (and non-adjacent) windows;
+///   union, intersection and difference are single merge passes (i.e.
+///   O(n+m)), building a set from arbitrary windows is O(n log n).
+/// - an ngpt::interval_tree holds arbitrary (possibly overlapping) windows,
+///   sorted by start, with an implicit, augmented binary tree laid over the
+///   array (as in H. Li's cgranges): the node at position i is at level
+///   "number of trailing 1 bits of i" and stores the maximum stop of its
+///   subtree. Queries cost O(log n + k) for k results, with no pointers.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_INTERVALS__
+#define __NGPT_DT_INTERVALS__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_binary.hpp"
+
+namespace ngpt
+{
+
+/// @struct epoch_window
+/// A time window [start, stop).
+template<typename S>
+  struct epoch_window
+{
+  datetime<S> start; ///< first epoch of the window
+  datetime<S> stop;  ///< first epoch after the window
+};// epoch_window
+
+namespace dtchars
+{
+
+/// A time window [start, stop) in linear ticks.
+struct tick_window
+{
+  std::int64_t start; ///< first tick of the window
+  std::int64_t stop;  ///< first tick after the window
+};// tick_window
+
+/// @brief A datetime_interval of the given (non-negative) number of ticks.
+template<typename S>
+  datetime_interval<S>
+  ticks_to_interval(std::int64_t ticks) noexcept
+{
+  return datetime_interval<S>{modified_julian_day{
+    static_cast<long>(ticks / S::max_in_day)},
+    S{static_cast<typename S::underlying_type>(ticks % S::max_in_day)}};
+}
+
+} // namespace dtchars
+
+/// @brief A set of epochs, represented as sorted, disjoint time windows.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class interval_set
+{
+public:
+  /// An empty set.
+  interval_set() noexcept = default;
+
+  /// @brief The union of n (arbitrary, i.e. unsorted and possibly
+  ///        overlapping) windows; empty windows are ignored.
+  interval_set(const epoch_window<S>* windows, std::size_t n)
+  {
+    m_win.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+      const dtchars::tick_window w {to_linear_ticks(windows[i].start),
+                                    to_linear_ticks(windows[i].stop)};
+      if (w.start < w.stop) m_win.push_back(w);
+    }
+    std::sort(m_win.begin(), m_win.end(),
+      [](const dtchars::tick_window& a, const dtchars::tick_window& b)
+      { return a.start < b.start; });
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < m_win.size(); i++) {
+      if (k && m_win[i].start <= m_win[k-1].stop) {
+        m_win[k-1].stop = std::max(m_win[k-1].stop, m_win[i].stop);
+      } else {
+        m_win[k++] = m_win[i];
+      }
+    }
+    m_win.resize(k);
+  }
+
+  /// @brief Add the window [start, stop) (nothing happens if stop is not
+  ///        after start); O(log n), plus the shifting of later windows.
+  void
+  insert(const datetime<S>& start, const datetime<S>& stop)
+  {
+    std::int64_t a = to_linear_ticks(start), b = to_linear_ticks(stop);
+    if (a >= b) return;
+    // windows touching [a, b) are merged into it
+    auto first = std::lower_bound(m_win.begin(), m_win.end(), a,
+      [](const dtchars::tick_window& w, std::int64_t x)
+      { return w.stop < x; });
+    auto last = first;
+    while (last != m_win.end() && last->start <= b) {
+      a = std::min(a, last->start);
+      b = std::max(b, last->stop);
+      ++last;
+    }
+    first = m_win.erase(first, last);
+    m_win.insert(first, dtchars::tick_window{a, b});
+  }
+
+  /// @brief Add the window [start, start+length).
+  void
+  insert(const datetime<S>& start, const datetime_interval<S>& length)
+  {
+    const std::int64_t ticks = to_linear_ticks(start)
+      + static_cast<std::int64_t>(length.days().as_underlying_type())
+      * S::max_in_day + length.sec().as_underlying_type();
+    insert(start, from_linear_ticks<S>(ticks));
+  }
+
+  /// Number of (disjoint) windows.
+  std::size_t
+  size() const noexcept
+  { return m_win.size(); }
+
+  /// Is the set empty?
+  bool
+  empty() const noexcept
+  { return m_win.empty(); }
+
+  /// The i-th window (in chronological order; no bounds check).
+  epoch_window<S>
+  operator[](std::size_t i) const noexcept
+  {
+    return epoch_window<S>{from_linear_ticks<S>(m_win[i].start),
+                           from_linear_ticks<S>(m_win[i].stop)};
+  }
+
+  /// Does the set contain the epoch t? O(log n).
+  bool
+  contains(const datetime<S>& t) const noexcept
+  {
+    const std::int64_t x = to_linear_ticks(t);
+    auto it = std::upper_bound(m_win.cbegin(), m_win.cend(), x,
+      [](std::int64_t v, const dtchars::tick_window& w)
+      { return v < w.stop; });
+    return it != m_win.cend() && it->start <= x;
+  }
+
+  /// Total length of the windows.
+  datetime_interval<S>
+  coverage() const noexcept
+  {
+    std::int64_t total = 0;
+    for (const auto& w : m_win) total += w.stop - w.start;
+    return dtchars::ticks_to_interval<S>(total);
+  }
+
+  /// The union of two sets; O(n+m).
+  friend interval_set
+  interval_union(const interval_set& x, const interval_set& y)
+  {
+    interval_set r;
+    r.m_win.reserve(x.size() + y.size());
+    std::size_t i = 0, j = 0;
+    while (i < x.size() || j < y.size()) {
+      const dtchars::tick_window& w = (j == y.size()
+        || (i < x.size() && x.m_win[i].start < y.m_win[j].start))
+        ? x.m_win[i++] : y.m_win[j++];
+      if (!r.m_win.empty() && w.start <= r.m_win.back().stop)
+        r.m_win.back().stop = std::max(r.m_win.back().stop, w.stop);
+      else
+        r.m_win.push_back(w);
+    }
+    return r;
+  }
+
+  /// The intersection of two sets; O(n+m).
+  friend interval_set
+  interval_intersection(const interval_set& x, const interval_set& y)
+  {
+    interval_set r;
+    std::size_t i = 0, j = 0;
+    while (i < x.size() && j < y.size()) {
+      const std::int64_t a = std::max(x.m_win[i].start, y.m_win[j].start);
+      const std::int64_t b = std::min(x.m_win[i].stop, y.m_win[j].stop);
+      if (a < b) r.m_win.push_back(dtchars::tick_window{a, b});
+      (x.m_win[i].stop < y.m_win[j].stop) ? ++i : ++j;
+    }
+    return r;
+  }
+
+  /// The difference x - y of two sets; O(n+m).
+  friend interval_set
+  interval_difference(const interval_set& x, const interval_set& y)
+  {
+    interval_set r;
+    std::size_t j = 0;
+    for (const auto& w : x.m_win) {
+      std::int64_t a = w.start;
+      while (j < y.size() && y.m_win[j].stop <= a) ++j;
+      for (std::size_t k = j; k < y.size() && y.m_win[k].start < w.stop;
+        k++) {
+        if (a < y.m_win[k].start)
+          r.m_win.push_back(dtchars::tick_window{a, y.m_win[k].start});
+        a = std::max(a, y.m_win[k].stop);
+      }
+      if (a < w.stop) r.m_win.push_back(dtchars::tick_window{a, w.stop});
+    }
+    return r;
+  }
+
+private:
+  std::vector<dtchars::tick_window> m_win; ///< sorted, disjoint windows
+};// interval_set
+
+/// @brief A static interval tree over (possibly overlapping) time windows,
+///        for stabbing and overlap queries (see the file description).
+///
+/// Query results are the positions of the windows in the array the tree was
+/// built from.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class interval_tree
+{
+public:
+  /// @brief Build the tree of n windows; O(n log n).
+  interval_tree(const epoch_window<S>* windows, std::size_t n)
+    : m_nodes(n),
+      m_max_level{-1}
+  {
+    for (std::size_t i = 0; i < n; i++) {
+      const std::int64_t a = to_linear_ticks(windows[i].start);
+      const std::int64_t b = to_linear_ticks(windows[i].stop);
+      m_nodes[i] = node{a, b, b, i};
+    }
+    std::sort(m_nodes.begin(), m_nodes.end(),
+      [](const node& x, const node& y) { return x.start < y.start; });
+    build();
+  }
+
+  /// Number of windows.
+  std::size_t
+  size() const noexcept
+  { return m_nodes.size(); }
+
+  /// @brief Write the positions of the windows containing t to out.
+  /// @return Iterator past the last position written.
+  template<typename OutputIt>
+    OutputIt
+    stab(const datetime<S>& t, OutputIt out) const
+  {
+    const std::int64_t x = to_linear_ticks(t);
+    return query(x, x + 1, out);
+  }
+
+  /// @brief Write the positions of the windows overlapping [start, stop)
+  ///        to out.
+  /// @return Iterator past the last position written.
+  template<typename OutputIt>
+    OutputIt
+    overlap(const datetime<S>& start, const datetime<S>& stop,
+      OutputIt out) const
+  { return query(to_linear_ticks(start), to_linear_ticks(stop), out); }
+
+private:
+  /// A window, with the maximum stop of its subtree.
+  struct node
+  {
+    std::int64_t start; ///< first tick of the window
+    std::int64_t stop;  ///< first tick after the window
+    std::int64_t max;   ///< maximum stop in the subtree
+    std::size_t  id;    ///< position in the input array
+  };
+
+  /// Compute the maximum stop of each subtree, bottom-up.
+  void
+  build() noexcept
+  {
+    const std::int64_t n = static_cast<std::int64_t>(m_nodes.size());
+    if (!n) return;
+    std::int64_t last_i = 0, last = 0;
+    for (std::int64_t i = 0; i < n; i += 2) {
+      last_i = i;
+      last = m_nodes[i].max = m_nodes[i].stop;
+    }
+    int k = 1;
+    for (; (std::int64_t{1} << k) <= n; ++k) {
+      const std::int64_t x = std::int64_t{1} << (k - 1);
+      const std::int64_t i0 = (x << 1) - 1, step = x << 2;
+      for (std::int64_t i = i0; i < n; i += step) {
+        const std::int64_t el = m_nodes[i - x].max;
+        const std::int64_t er = (i + x < n) ? m_nodes[i + x].max : last;
+        m_nodes[i].max = std::max(m_nodes[i].stop, std::max(el, er));
+      }
+      last_i = ((last_i >> k) & 1) ? last_i - x : last_i + x;
+      if (last_i < n && m_nodes[last_i].max > last)
+        last = m_nodes[last_i].max;
+    }
+    m_max_level = k - 1;
+  }
+
+  /// Report the windows overlapping [a, b).
+  template<typename OutputIt>
+    OutputIt
+    query(std::int64_t a, std::int64_t b, OutputIt out) const
+  {
+    if (m_max_level < 0) return out;
+    const std::int64_t n = static_cast<std::int64_t>(m_nodes.size());
+    struct frame { std::int64_t x; int k; bool right; };
+    frame stack[64];
+    int t = 0;
+    stack[t++] = frame{(std::int64_t{1} << m_max_level) - 1, m_max_level,
+                       false};
+    while (t) {
+      const frame z = stack[--t];
+      if (z.k <= 3) {
+        // small subtree; scan it
+        const std::int64_t i0 = z.x >> z.k << z.k;
+        const std::int64_t i1 = std::min(i0 + (std::int64_t{1} << (z.k + 1))
+                                         - 1, n);
+        for (std::int64_t i = i0; i < i1 && m_nodes[i].start < b; ++i)
+          if (a < m_nodes[i].stop) *out++ = m_nodes[i].id;
+      } else if (!z.right) {
+        // visit the left subtree (if it can overlap), then come back
+        const std::int64_t y = z.x - (std::int64_t{1} << (z.k - 1));
+        stack[t++] = frame{z.x, z.k, true};
+        if (y >= n || m_nodes[y].max > a) stack[t++] = frame{y, z.k - 1, false};
+      } else if (z.x < n && m_nodes[z.x].start < b) {
+        if (a < m_nodes[z.x].stop) *out++ = m_nodes[z.x].id;
+        stack[t++] = frame{z.x + (std::int64_t{1} << (z.k - 1)), z.k - 1,
+                           false};
+      }
+    }
+    return out;
+  }
+
+  std::vector<node> m_nodes;     ///< windows, sorted by start
+  int               m_max_level; ///< level of the root (-1 if empty)
+};// interval_tree
+
+} // namespace ngpt
+
+#endif
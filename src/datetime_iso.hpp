@@ -0,0 +1,265 @@
+///
+/// @file  datetime_iso.hpp
+///
+/// @brief Parsing of ISO 8601 and RFC 3339 date/time strings.
+///
+/// The following ISO 8601 representations are recognized, in both the basic
+/// and the extended format:
+/// - calendar dates, e.g. 2015-12-30 or 20151230
+/// - ordinal dates, e.g. 2015-364 or 2015364
+/// - week dates, e.g. 2015-W53-3, 2015W533 or 2015-W53 (i.e. the Monday)
+///
+/// optionally followed by a time of day, separated by a 'T' (or a blank):
+/// hh[:mm[:ss]] or hh[mm[ss]], where the last component can have a decimal
+/// fraction (either '.' or ',' is used as decimal sign). 24:00:00 denotes the
+/// end of the day. The time can be followed by a UTC designator ('Z') or an
+/// offset, i.e. +hh:mm, +hhmm or +hh (or with a '-' sign); the resulting
+/// datetime is always normalized to UTC, by shifting it (by an integral
+/// number of ticks) by the offset. If no offset is given, the time is
+/// returned as is (i.e. local time).
+///
+/// RFC 3339 is a strict profile of the above; see ngpt::parse_rfc3339.
+///
+/// Parsing follows the conventions of std::from_chars, i.e. it does not
+/// allocate, does not throw and reports errors via an std::errc code
+/// (see ngpt::datetime_format::parse).
+///
+/// @code
+///   ngpt::datetime<ngpt::milliseconds> t;
+///   const char* str = "2015-W53-3T12:09:30.001+02:00";
+///   auto res = ngpt::parse_iso8601(str, str+std::strlen(str), t);
+///   if (res.ec != std::errc{}) { /* handle error */ }
+/// @endcode
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_ISO__
+#define __NGPT_DT_ISO__
+
+#include <charconv>
+#include <system_error>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "dtchars.hpp"
+
+namespace ngpt
+{
+
+namespace dtchars
+{
+
+/// @brief Resolve an unsigned integer of exactly n digits.
+/// @return Pointer to the first character not interpreted, or nullptr if
+///         there are not n digits available.
+inline const char*
+parse_uint_n(const char* first, const char* last, int n, long& val) noexcept
+{
+  if (last - first < n) return nullptr;
+  long v = 0L;
+  for (int i = 0; i < n; i++) {
+    if (!is_digit(first[i])) return nullptr;
+    v = v * 10L + (first[i] - '0');
+  }
+  val = v;
+  return first + n;
+}
+
+/// @brief Number of consecutive digits at the start of [first, last).
+inline int
+digit_run(const char* first, const char* last) noexcept
+{
+  const char* p = first;
+  while (p < last && is_digit(*p)) ++p;
+  return static_cast<int>(p - first);
+}
+
+/// @brief ISO weekday of a Modified Julian Day, i.e. 1 for Monday to 7 for
+///        Sunday (MJD 0 was a Wednesday).
+constexpr int
+iso_weekday(long mjd) noexcept
+{ return static_cast<int>(((mjd + 2L) % 7L + 7L) % 7L) + 1; }
+
+/// @brief The MJD of the Monday of ISO week 1 of a year, i.e. of the week
+///        that contains January 4th.
+inline long
+iso_week1_monday(long y) noexcept
+{
+  const long jan4 = ydoy2mjd(year{static_cast<year::underlying_type>(y)},
+    day_of_year{4}).as_underlying_type();
+  return jan4 - (iso_weekday(jan4) - 1);
+}
+
+/// @brief Implementation of ngpt::parse_iso8601 and ngpt::parse_rfc3339.
+/// @param[in] strict If true, only the RFC 3339 profile is accepted.
+template<typename S>
+  std::from_chars_result
+  parse_iso_impl(const char* first, const char* last, datetime<S>& t,
+    bool strict) noexcept
+{
+  constexpr std::errc mismatch = std::errc::invalid_argument;
+  constexpr int sdigits = sec_digits<S>();
+  const char* p = first;
+  long yr, v1 = 0L, v2 = 0L;
+
+  // -- date --
+  if (!(p = parse_uint_n(p, last, 4, yr))) return {first, mismatch};
+  const bool extended = (p < last && *p == '-');
+  if (extended) ++p;
+  long mjd;
+  if (p < last && *p == 'W' && !strict) {
+    // week date
+    if (!(p = parse_uint_n(p+1, last, 2, v1))) return {first, mismatch};
+    v2 = 1L;
+    if (extended && p + 1 < last && *p == '-' && is_digit(p[1])) {
+      p = parse_uint_n(p+1, last, 1, v2);
+    } else if (!extended && p < last && is_digit(*p)) {
+      p = parse_uint_n(p, last, 1, v2);
+    }
+    const long monday = iso_week1_monday(yr);
+    if (v1 < 1L || v1 > 53L || v2 < 1L || v2 > 7L
+      || (v1 == 53L && iso_week1_monday(yr + 1L) - monday < 53L * 7L))
+      return {p, std::errc::result_out_of_range};
+    mjd = monday + (v1 - 1L) * 7L + (v2 - 1L);
+  } else {
+    const int run = digit_run(p, last);
+    if (run == 3 && !strict) {
+      // ordinal date
+      p = parse_uint_n(p, last, 3, v1);
+      day_of_year doy {static_cast<day_of_year::underlying_type>(v1)};
+      year y {static_cast<year::underlying_type>(yr)};
+      if (!doy.is_valid(y)) return {p, std::errc::result_out_of_range};
+      mjd = ydoy2mjd(y, doy).as_underlying_type();
+    } else if ((extended && run == 2) || (!extended && run == 4 && !strict)) {
+      // calendar date
+      p = parse_uint_n(p, last, 2, v1);
+      if (extended) {
+        if (p >= last || *p != '-') return {first, mismatch};
+        ++p;
+      }
+      if (!(p = parse_uint_n(p, last, 2, v2))) return {first, mismatch};
+      ymd_date ymd {year{static_cast<year::underlying_type>(yr)},
+        month{static_cast<month::underlying_type>(v1)},
+        day_of_month{static_cast<day_of_month::underlying_type>(v2)}};
+      if (!ymd.is_valid()) return {p, std::errc::result_out_of_range};
+      mjd = cal2mjd(ymd.__year, ymd.__month, ymd.__dom).as_underlying_type();
+    } else {
+      return {first, mismatch};
+    }
+  }
+
+  // -- time of day --
+  const bool has_time = p + 1 < last && is_digit(p[1])
+    && (*p == 'T' || *p == 't' || *p == ' ');
+  if (!has_time) {
+    if (strict) return {first, mismatch};
+    t = datetime<S>{modified_julian_day{mjd}, S{0L}};
+    return {p, std::errc{}};
+  }
+  ++p;
+  long hms[3] = {0L, 0L, 0L};
+  int  ncomp = 0;
+  const bool ext_time = p + 2 < last && p[2] == ':';
+  do {
+    if (!(p = parse_uint_n(p, last, 2, hms[ncomp])))
+      return {first, mismatch};
+    ++ncomp;
+    if (ncomp == 3) break;
+    if (ext_time) {
+      if (p + 1 < last && *p == ':' && is_digit(p[1])) {
+        ++p;
+      } else {
+        break;
+      }
+    } else if (p >= last || !is_digit(*p)) {
+      break;
+    }
+  } while (true);
+  if (strict && (ncomp != 3 || !ext_time)) return {first, mismatch};
+
+  // decimal fraction of the last component, resolved to ticks (truncated)
+  long frac = 0L;
+  if (p + 1 < last && (*p == '.' || *p == ',') && is_digit(p[1])) {
+    constexpr long unit[] = {3600L, 60L, 1L};
+    p = parse_fraction(p+1, last, sdigits + 4, frac);
+    frac = frac * unit[ncomp-1] / 10000L;
+  }
+  if (hms[0] > 24L || hms[1] > 59L || hms[2] > 60L
+    || (hms[0] == 24L && (hms[1] || hms[2] || frac)))
+    return {p, std::errc::result_out_of_range};
+
+  // -- UTC designator or offset (in minutes) --
+  long offset = 0L;
+  if (p < last && (*p == 'Z' || *p == 'z')) {
+    ++p;
+  } else if (p < last && (*p == '+' || *p == '-')) {
+    const long sign = (*p == '-') ? -1L : 1L;
+    if (!(p = parse_uint_n(p+1, last, 2, v1))) return {first, mismatch};
+    v2 = 0L;
+    if (p + 1 < last && *p == ':' && is_digit(p[1])) {
+      if (!(p = parse_uint_n(p+1, last, 2, v2))) return {first, mismatch};
+    } else if (strict) {
+      return {first, mismatch};
+    } else if (p < last && is_digit(*p)) {
+      if (!(p = parse_uint_n(p, last, 2, v2))) return {first, mismatch};
+    }
+    if (v1 > 23L || v2 > 59L) return {p, std::errc::result_out_of_range};
+    offset = sign * (v1 * 60L + v2);
+  } else if (strict) {
+    return {first, mismatch};
+  }
+
+  const long factor = S::template sec_factor<long>();
+  typename S::underlying_type ticks = ((hms[0] * 60L + hms[1] - offset) * 60L
+    + hms[2]) * factor + frac;
+  t = datetime<S>{modified_julian_day{mjd}, S{ticks}};
+  return {p, std::errc{}};
+}
+
+} // namespace dtchars
+
+/// @brief Parse an ISO 8601 date/time string.
+///
+/// See the file description for the recognized representations. Trailing
+/// characters (after the date/time) are not interpreted; check the returned
+/// pointer if the whole string should be consumed.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true. Fractional
+///           seconds beyond the precision of S are truncated.
+/// @param[in]  first Start of the character range
+/// @param[in]  last  End of the character range (one past the last char)
+/// @param[out] t     The resolved datetime (normalized to UTC if an offset is
+///                   given); only changed on success.
+/// @return An std::from_chars_result; on success, ptr points to the first
+///         character not interpreted and ec is std::errc{}. On failure ec is
+///         std::errc::invalid_argument if the string does not match any of
+///         the representations, or std::errc::result_out_of_range if a
+///         field (or the offset) is out of its valid range.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::from_chars_result
+  parse_iso8601(const char* first, const char* last, datetime<S>& t) noexcept
+{ return dtchars::parse_iso_impl(first, last, t, false); }
+
+/// @brief Parse an RFC 3339 date/time string.
+///
+/// RFC 3339 strings are of the form YYYY-MM-DDThh:mm:ss[.f](Z|+hh:mm|-hh:mm),
+/// i.e. an extended calendar date and a full time of day, with a mandatory
+/// UTC designator or offset. A lowercase 't'/'z' or a blank instead of the 'T'
+/// are also accepted (see RFC 3339, section 5.6).
+///
+/// @see ngpt::parse_iso8601 for the parameters and the returned value.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::from_chars_result
+  parse_rfc3339(const char* first, const char* last, datetime<S>& t) noexcept
+{ return dtchars::parse_iso_impl(first, last, t, true); }
+
+} // namespace ngpt
+
+#endif
@@ -0,0 +1,156 @@
+///
+/// @file  datetime_join.hpp
+///
+/// @brief Tolerant merge-join of two sorted epoch arrays, i.e. pairing of
+///        epochs that lie within a given tolerance of each other (e.g. to
+///        match observations of two receivers, or observations against a
+///        clock product).
+///
+/// Both arrays are cast once to linear ticks of the more precise of the two
+/// second types; the join is then a single, merge-like pass over integers,
+/// i.e. it runs in O(n+m) (plus the number of pairs emitted for
+/// join_policy::all). Runs of right-hand epochs far before the current
+/// left-hand one are skipped in blocks, with one comparison per block.
+///
+/// @code
+///   std::vector<ngpt::join_pair> pairs;
+///   ngpt::merge_join(obs1.data(), obs1.size(), obs2.data(), obs2.size(),
+///     ngpt::milliseconds{50L}, ngpt::join_policy::nearest,
+///     std::back_inserter(pairs));
+/// @endcode
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_JOIN__
+#define __NGPT_DT_JOIN__
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+
+namespace ngpt
+{
+
+/// @enum join_policy
+/// Which right-hand epochs to pair with each left-hand epoch.
+enum class join_policy
+: char
+{
+  nearest, ///< the closest one within tolerance (the earlier one on ties)
+  first,   ///< the first (earliest) one within tolerance
+  all      ///< all of the ones within tolerance
+};// join_policy
+
+/// @struct join_pair
+/// A pair of matched epochs, as positions in the left and right arrays.
+struct join_pair
+{
+  std::size_t left;  ///< position in the left-hand array
+  std::size_t right; ///< position in the right-hand array
+};// join_pair
+
+namespace dtchars
+{
+
+/// @brief Linear ticks (since MJD 0) of epochs of type S, in (the more
+///        precise) second type F.
+/// @throw std::invalid_argument if the epochs are not sorted.
+template<typename F, typename S>
+  std::vector<std::int64_t>
+  ticks_in(const datetime<S>* epochs, std::size_t n)
+{
+  std::vector<std::int64_t> v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    v[i] = static_cast<std::int64_t>(epochs[i].mjd().as_underlying_type())
+      * F::max_in_day
+      + ngpt::cast_to<S, F>(epochs[i].sec()).as_underlying_type();
+    if (i && v[i] < v[i-1])
+      throw std::invalid_argument("merge_join: epochs are not sorted");
+  }
+  return v;
+}
+
+/// @brief The first position in [j, n) where v is not less than x (n if
+///        none); v is sorted.
+inline std::size_t
+advance_to(const std::int64_t* v, std::size_t n, std::size_t j,
+  std::int64_t x) noexcept
+{
+  constexpr std::size_t block = 8;
+  while (j + block <= n && v[j + block - 1] < x) j += block;
+  while (j < n && v[j] < x) ++j;
+  return j;
+}
+
+} // namespace dtchars
+
+/// @brief Tolerant merge-join of two sorted epoch arrays.
+///
+/// For each left-hand epoch (in order), the right-hand epochs within tol of
+/// it are paired with it according to the policy; the pairs are written to
+/// out ordered by left (and, for join_policy::all, right) position.
+///
+/// @tparam S1 Second type of the left-hand epochs
+/// @tparam S2 Second type of the right-hand epochs
+/// @param[in] a      The left-hand epochs, sorted
+/// @param[in] na     Number of left-hand epochs
+/// @param[in] b      The right-hand epochs, sorted
+/// @param[in] nb     Number of right-hand epochs
+/// @param[in] tol    The tolerance (inclusive), in the more precise of S1
+///                   and S2
+/// @param[in] policy Which right-hand epochs to pair
+/// @param[in] out    Output iterator of ngpt::join_pair
+/// @return Iterator past the last pair written.
+/// @throw std::invalid_argument if any of the arrays is not sorted.
+template<typename S1, typename S2, typename OutputIt,
+        typename = std::enable_if_t<S1::is_of_sec_type>,
+        typename = std::enable_if_t<S2::is_of_sec_type>
+        >
+  OutputIt
+  merge_join(const datetime<S1>* a, std::size_t na, const datetime<S2>* b,
+    std::size_t nb, finer_sec_t<S1, S2> tol, join_policy policy,
+    OutputIt out)
+{
+  using F = finer_sec_t<S1, S2>;
+  const std::vector<std::int64_t> va = dtchars::ticks_in<F>(a, na);
+  const std::vector<std::int64_t> vb = dtchars::ticks_in<F>(b, nb);
+  const std::int64_t* pb = vb.data();
+  const std::int64_t t = tol.as_underlying_type();
+
+  // lo: first right epoch not before a[i]-tol; ge: first not before a[i]
+  std::size_t lo = 0, ge = 0;
+  for (std::size_t i = 0; i < na; i++) {
+    const std::int64_t x = va[i];
+    lo = dtchars::advance_to(pb, nb, lo, x - t);
+    if (lo == nb) break;
+    if (pb[lo] > x + t) continue;
+    switch (policy) {
+      case join_policy::first:
+        *out++ = join_pair{i, lo};
+        break;
+      case join_policy::all:
+        for (std::size_t j = lo; j < nb && pb[j] <= x + t; j++)
+          *out++ = join_pair{i, j};
+        break;
+      default: {
+        ge = dtchars::advance_to(pb, nb, ge < lo ? lo : ge, x);
+        // candidates are ge-1 (if not before lo) and ge; one is in range
+        std::size_t j = ge;
+        if (ge == nb || (ge > lo && x - pb[ge-1] <= pb[ge] - x)) j = ge - 1;
+        *out++ = join_pair{i, j};
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace ngpt
+
+#endif
@@ -0,0 +1,269 @@
+///
+/// @file  datetime_range.hpp
+///
+/// @brief A lazy, random-access view of an evenly spaced sequence of epochs,
+///        i.e. [start, stop) with a fixed step.
+///
+/// The sequence is never materialized: the k-th epoch is computed (in O(1),
+/// with integer arithmetic on linear ticks) when accessed. Since no element
+/// depends on the previous one, a range can be sliced or partitioned, e.g.
+/// to process a grid in parallel:
+/// @code
+///   ngpt::epoch_range<ngpt::milliseconds> grid {start, stop,
+///                                              ngpt::milliseconds{30000L}};
+///   // in thread i (of nthreads)
+///   for (const auto& t : grid.partition(i, nthreads)) process(t);
+/// @endcode
+///
+/// The iterators are random-access (with a prvalue reference type, like the
+/// ones of std::ranges::iota_view), so that epoch_range models
+/// std::ranges::random_access_range and std::ranges::sized_range when
+/// compiled as C++20; with C++17 they work with any algorithm taking
+/// random-access iterators (e.g. std::lower_bound).
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_RANGE__
+#define __NGPT_DT_RANGE__
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_binary.hpp"
+
+namespace ngpt
+{
+
+/// @brief A lazy view of the epochs start, start+step, ... before stop.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class epoch_range
+{
+public:
+  /// @brief Random-access iterator over an epoch_range; dereferencing
+  ///        computes the epoch.
+  class iterator
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept  = std::random_access_iterator_tag;
+    using value_type        = datetime<S>;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = datetime<S>;
+    using pointer           = void;
+
+    /// Singular iterator.
+    constexpr iterator() noexcept
+      : m_start{0},
+        m_step{0},
+        m_k{0}
+    {}
+
+    /// Iterator at position k of the range start, start+step, ...
+    constexpr iterator(std::int64_t start, std::int64_t step,
+      difference_type k) noexcept
+      : m_start{start},
+        m_step{step},
+        m_k{k}
+    {}
+
+    datetime<S>
+    operator*() const noexcept
+    { return from_linear_ticks<S>(m_start + m_k * m_step); }
+
+    datetime<S>
+    operator[](difference_type n) const noexcept
+    { return from_linear_ticks<S>(m_start + (m_k + n) * m_step); }
+
+    constexpr iterator&
+    operator++() noexcept
+    { ++m_k; return *this; }
+
+    constexpr iterator
+    operator++(int) noexcept
+    { iterator it {*this}; ++m_k; return it; }
+
+    constexpr iterator&
+    operator--() noexcept
+    { --m_k; return *this; }
+
+    constexpr iterator
+    operator--(int) noexcept
+    { iterator it {*this}; --m_k; return it; }
+
+    constexpr iterator&
+    operator+=(difference_type n) noexcept
+    { m_k += n; return *this; }
+
+    constexpr iterator&
+    operator-=(difference_type n) noexcept
+    { m_k -= n; return *this; }
+
+    friend constexpr iterator
+    operator+(iterator it, difference_type n) noexcept
+    { return it += n; }
+
+    friend constexpr iterator
+    operator+(difference_type n, iterator it) noexcept
+    { return it += n; }
+
+    friend constexpr iterator
+    operator-(iterator it, difference_type n) noexcept
+    { return it -= n; }
+
+    friend constexpr difference_type
+    operator-(const iterator& a, const iterator& b) noexcept
+    { return a.m_k - b.m_k; }
+
+    friend constexpr bool
+    operator==(const iterator& a, const iterator& b) noexcept
+    { return a.m_k == b.m_k; }
+
+    friend constexpr bool
+    operator!=(const iterator& a, const iterator& b) noexcept
+    { return a.m_k != b.m_k; }
+
+    friend constexpr bool
+    operator<(const iterator& a, const iterator& b) noexcept
+    { return a.m_k < b.m_k; }
+
+    friend constexpr bool
+    operator>(const iterator& a, const iterator& b) noexcept
+    { return a.m_k > b.m_k; }
+
+    friend constexpr bool
+    operator<=(const iterator& a, const iterator& b) noexcept
+    { return a.m_k <= b.m_k; }
+
+    friend constexpr bool
+    operator>=(const iterator& a, const iterator& b) noexcept
+    { return a.m_k >= b.m_k; }
+
+  private:
+    std::int64_t    m_start; ///< ticks of the first epoch of the range
+    std::int64_t    m_step;  ///< the step in ticks
+    difference_type m_k;     ///< the position
+  };// iterator
+
+  using const_iterator = iterator;
+  using value_type     = datetime<S>;
+  using size_type      = std::size_t;
+
+  /// @brief The epochs start, start+step, ... before stop (empty if stop is
+  ///        not after start).
+  /// @throw std::invalid_argument if the step is not positive.
+  epoch_range(const datetime<S>& start, const datetime<S>& stop, S step)
+    : m_start{to_linear_ticks(start)},
+      m_step{step.as_underlying_type()},
+      m_size{0}
+  {
+    if (m_step <= 0)
+      throw std::invalid_argument("epoch_range: step must be positive");
+    const std::int64_t span = to_linear_ticks(stop) - m_start;
+    if (span > 0)
+      m_size = static_cast<std::size_t>((span + m_step - 1) / m_step);
+  }
+
+  /// @brief The n epochs start, start+step, ...
+  /// @throw std::invalid_argument if the step is not positive.
+  epoch_range(const datetime<S>& start, S step, std::size_t n)
+    : m_start{to_linear_ticks(start)},
+      m_step{step.as_underlying_type()},
+      m_size{n}
+  {
+    if (m_step <= 0)
+      throw std::invalid_argument("epoch_range: step must be positive");
+  }
+
+  /// Number of epochs.
+  constexpr std::size_t
+  size() const noexcept
+  { return m_size; }
+
+  /// Is the range empty?
+  constexpr bool
+  empty() const noexcept
+  { return !m_size; }
+
+  /// The step.
+  S
+  step() const noexcept
+  { return S{static_cast<typename S::underlying_type>(m_step)}; }
+
+  constexpr iterator
+  begin() const noexcept
+  { return iterator{m_start, m_step, 0}; }
+
+  constexpr iterator
+  end() const noexcept
+  {
+    return iterator{m_start, m_step, static_cast<std::ptrdiff_t>(m_size)};
+  }
+
+  /// The k-th epoch (no bounds check).
+  datetime<S>
+  operator[](std::size_t k) const noexcept
+  {
+    return from_linear_ticks<S>(m_start
+      + static_cast<std::int64_t>(k) * m_step);
+  }
+
+  /// The first epoch (the range must not be empty).
+  datetime<S>
+  front() const noexcept
+  { return (*this)[0]; }
+
+  /// The last epoch (the range must not be empty).
+  datetime<S>
+  back() const noexcept
+  { return (*this)[m_size - 1]; }
+
+  /// @brief The sub-range of the epochs at positions [first, last) (clamped
+  ///        to the range).
+  epoch_range
+  slice(std::size_t first, std::size_t last) const noexcept
+  {
+    if (last > m_size) last = m_size;
+    if (first > last) first = last;
+    return epoch_range{m_start + static_cast<std::int64_t>(first) * m_step,
+                       m_step, last - first};
+  }
+
+  /// @brief The i-th of n contiguous parts of (nearly) equal size, e.g. the
+  ///        share of thread i of n; the parts cover the range in order.
+  epoch_range
+  partition(std::size_t i, std::size_t n) const noexcept
+  {
+    if (!n) return slice(0, 0);
+    const std::size_t q = m_size / n, r = m_size % n;
+    const std::size_t first = i * q + (i < r ? i : r);
+    return slice(first, first + q + (i < r));
+  }
+
+private:
+  /// Constructor from (valid) ticks.
+  constexpr epoch_range(std::int64_t start, std::int64_t step, std::size_t n)
+    noexcept
+    : m_start{start},
+      m_step{step},
+      m_size{n}
+  {}
+
+  std::int64_t m_start; ///< ticks of the first epoch
+  std::int64_t m_step;  ///< the step, in ticks
+  std::size_t  m_size;  ///< number of epochs
+};// epoch_range
+
+} // namespace ngpt
+
+#endif
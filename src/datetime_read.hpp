@@ -158,8 +158,6 @@ template<typename T>
   char *end;
   const char* start = str;
   int ints[5];
-  char month_str[4];
-  month_str[3] = '\0';
   double secs;
 
   ints[0] = static_cast<int>(std::abs(std::strtol(start, &end, 10)));
@@ -171,11 +169,10 @@ template<typename T>
   start = end+1;
 
   if ( !std::isalpha(*start) ) ++start;
-  std::memcpy(month_str, start, 3);
-  month_str[0] = std::toupper(month_str[0]);
-  month_str[1] = std::tolower(month_str[1]);
-  month_str[2] = std::tolower(month_str[2]);
-  month mnt {month_str};
+  month mnt {month_from_str(start, 3)};
+  if (!mnt.as_underlying_type())
+    throw std::invalid_argument
+      ("Invalid date format: \""+std::string(str)+"\" (argument #2).");
   start += 4;
 
   for (int i = 2; i < 5; ++i) {
@@ -0,0 +1,203 @@
+///
+/// @file  datetime_rinex.hpp
+///
+/// @brief Epoch writers for GNSS product files (RINEX, SP3, clock RINEX).
+///
+/// Epochs are written at the fixed columns required by the respective
+/// format, with the fractional seconds rendered exactly from the integral
+/// ticks of the datetime (i.e. 59.9999996 is never rounded up to 60.0000000).
+/// If the precision of the second type is less than the number of digits the
+/// format requires, the fraction is padded with zeros; if it is more, it is
+/// truncated.
+///
+/// The supported epoch formats are (see ngpt::gnss_epoch):
+/// @code
+///   RINEX 2 obs : " 15 12 30  2  9 59.9999960"       (1X,I2.2,4(1X,I2),F11.7)
+///   RINEX 3 obs : "> 2015 12 30 02 09 59.9999960"    (A1,1X,I4,4(1X,I2.2),F11.7)
+///   SP3         : "*  2015 12 30  2  9 59.99999600"  (A2,1X,I4,4(1X,I2),1X,F11.8)
+///   clock RINEX : "2015 12 30  2  9 59.999996"       (I4,4I3,F10.6)
+/// @endcode
+///
+/// For whole files, use an ngpt::epoch_writer constructed with a
+/// ngpt::gnss_epoch format.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_RINEX__
+#define __NGPT_DT_RINEX__
+
+#include <charconv>
+#include <system_error>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "dtchars.hpp"
+
+namespace ngpt
+{
+
+/// @enum gnss_epoch
+/// Epoch (fixed-column) formats of GNSS product files.
+enum class gnss_epoch
+: char
+{
+  rinex2_obs, ///< RINEX v2.x observation record
+  rinex3_obs, ///< RINEX v3.x observation record
+  sp3,        ///< SP3 (c/d) epoch header line
+  rinex_clk   ///< epoch of a clock RINEX data record
+};// gnss_epoch
+
+namespace dtchars
+{
+
+/// @brief Write a non-negative integer, right-aligned (padded with blanks)
+///        in exactly w chars.
+/// @return Pointer to one past the last character written.
+inline char*
+write_uint_blank(char* p, unsigned long v, int w) noexcept
+{
+  char* end = write_uint(p, v, w);
+  for (char* q = p; q < end - 1 && *q == '0'; ++q) *q = ' ';
+  return end;
+}
+
+/// @brief Number of chars of an epoch in the given format.
+constexpr int
+gnss_epoch_chars(gnss_epoch f) noexcept
+{
+  switch (f) {
+    case gnss_epoch::rinex2_obs: return 26;
+    case gnss_epoch::rinex3_obs: return 29;
+    case gnss_epoch::sp3:        return 31;
+    default:                     return 26;
+  }
+}
+
+/// @brief Write the date part of an epoch, i.e. everything up to (and
+///        excluding) the hours field.
+/// @return Pointer to one past the last character written.
+inline char*
+write_gnss_date(char* p, gnss_epoch f, const ymd_date& d) noexcept
+{
+  const long y = d.__year.as_underlying_type();
+  const long m = d.__month.as_underlying_type();
+  const long dd = d.__dom.as_underlying_type();
+  switch (f) {
+    case gnss_epoch::rinex2_obs:
+      *p++ = ' ';
+      p = write_2digits(p, y % 100L);
+      *p++ = ' ';
+      p = write_uint_blank(p, m, 2);
+      *p++ = ' ';
+      return write_uint_blank(p, dd, 2);
+    case gnss_epoch::rinex3_obs:
+      *p++ = '>';
+      *p++ = ' ';
+      p = write_uint(p, y, 4);
+      *p++ = ' ';
+      p = write_2digits(p, m);
+      *p++ = ' ';
+      return write_2digits(p, dd);
+    case gnss_epoch::sp3:
+      *p++ = '*';
+      *p++ = ' ';
+      *p++ = ' ';
+      p = write_uint(p, y, 4);
+      *p++ = ' ';
+      p = write_uint_blank(p, m, 2);
+      *p++ = ' ';
+      return write_uint_blank(p, dd, 2);
+    default:
+      p = write_uint(p, y, 4);
+      p = write_uint_blank(p, m, 3);
+      return write_uint_blank(p, dd, 3);
+  }
+}
+
+/// @brief Write the time part of an epoch (i.e. hours, minutes and seconds)
+///        in the given format.
+///
+/// @tparam S Any class of second type.
+/// @param[in] p     Where to write
+/// @param[in] f     The epoch format
+/// @param[in] ticks Time of day in S (e.g. datetime::sec_as_i)
+/// @return Pointer to one past the last character written.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  char*
+  write_gnss_time(char* p, gnss_epoch f, long ticks) noexcept
+{
+  constexpr long factor = S::template sec_factor<long>();
+  constexpr int  sdigits = sec_digits<S>();
+  const long tsec = ticks / factor;
+  const long hr = tsec / 3600L;
+  const long mn = (tsec % 3600L) / 60L;
+  const long sc = tsec % 60L;
+  int iw, fw; // width of integral seconds and number of fractional digits
+  switch (f) {
+    case gnss_epoch::rinex2_obs:
+      *p++ = ' ';
+      p = write_uint_blank(p, hr, 2);
+      *p++ = ' ';
+      p = write_uint_blank(p, mn, 2);
+      iw = 3; fw = 7;
+      break;
+    case gnss_epoch::rinex3_obs:
+      *p++ = ' ';
+      p = write_2digits(p, hr);
+      *p++ = ' ';
+      p = write_2digits(p, mn);
+      iw = 3; fw = 7;
+      break;
+    case gnss_epoch::sp3:
+      *p++ = ' ';
+      p = write_uint_blank(p, hr, 2);
+      *p++ = ' ';
+      p = write_uint_blank(p, mn, 2);
+      *p++ = ' ';
+      iw = 2; fw = 8;
+      break;
+    default:
+      p = write_uint_blank(p, hr, 3);
+      p = write_uint_blank(p, mn, 3);
+      iw = 3; fw = 6;
+      break;
+  }
+  p = write_uint_blank(p, sc, iw);
+  *p++ = '.';
+  return write_fraction(p, ticks % factor, sdigits, fw);
+}
+
+} // namespace dtchars
+
+/// @brief Write an epoch in one of the GNSS product file formats.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+/// @param[in] first  Start of the buffer to write to
+/// @param[in] last   End of the buffer (one past the last char)
+/// @param[in] t      The epoch to write; years must be in the range [0,9999]
+/// @param[in] f      The epoch format
+/// @return An std::to_chars_result; on success, ptr points to one past the
+///         last character written (exactly dtchars::gnss_epoch_chars(f)
+///         chars are written) and ec is std::errc{}. If the buffer is too
+///         small, ec is std::errc::value_too_large.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::to_chars_result
+  to_chars_gnss_epoch(char* first, char* last, const datetime<S>& t,
+    gnss_epoch f) noexcept
+{
+  if (last - first < dtchars::gnss_epoch_chars(f))
+    return {last, std::errc::value_too_large};
+  char* p = dtchars::write_gnss_date(first, f, t.as_ymd());
+  return {dtchars::write_gnss_time<S>(p, f, t.sec_as_i()), std::errc{}};
+}
+
+} // namespace ngpt
+
+#endif
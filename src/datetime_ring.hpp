@@ -0,0 +1,308 @@
+///
+/// @file  datetime_ring.hpp
+///
+/// @brief Fixed-capacity containers for real-time streams of (epoch, value)
+///        pairs: a sliding time-window ring buffer and a single-producer,
+///        single-consumer lock-free queue.
+///
+/// Both containers allocate their storage once, at construction; pushing,
+/// popping and evicting never allocate. Epochs are stored as linear ticks
+/// (see ngpt::to_linear_ticks), in an array separate from the values, so that
+/// comparisons and binary searches only touch the ticks.
+///
+/// A typical setup hands epochs from a receiver thread to a solver thread via
+/// an spsc_epoch_queue; the solver keeps "the last N seconds" in an
+/// epoch_ring:
+/// @code
+///   // receiver thread
+///   while (!queue.try_push(t, obs)) ; // queue full; spin (or drop)
+///   // solver thread
+///   while (queue.try_pop(t, obs)) {
+///     ring.push(t, obs);
+///     ring.evict_older_than(seconds{300L});
+///   }
+/// @endcode
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_RING__
+#define __NGPT_DT_RING__
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_binary.hpp"
+
+namespace ngpt
+{
+
+/// @brief A fixed-capacity ring buffer of (epoch, value) pairs, with epochs
+///        in non-decreasing order, evicted by time window.
+///
+/// When the buffer is full, pushing a new pair overwrites the oldest one.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+/// @tparam T The type of the values (must be default-constructible and
+///           copy-assignable).
+template<typename S, typename T,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class epoch_ring
+{
+public:
+  /// @brief A buffer of the given capacity.
+  /// @throw std::invalid_argument if the capacity is zero.
+  explicit
+  epoch_ring(std::size_t capacity)
+    : m_ticks{check_capacity(capacity)},
+      m_values{new T[capacity]},
+      m_capacity{capacity},
+      m_head{0},
+      m_size{0}
+  {}
+
+  /// @brief Append a pair; if the buffer is full, the oldest pair is
+  ///        overwritten.
+  /// @return false (and nothing is appended) if t is before the newest epoch.
+  bool
+  push(const datetime<S>& t, const T& value)
+  {
+    const std::int64_t x = to_linear_ticks(t);
+    if (m_size && x < m_ticks[slot(m_size - 1)]) return false;
+    if (m_size == m_capacity) {
+      m_head = wrap(m_head + 1);
+      --m_size;
+    }
+    const std::size_t i = slot(m_size);
+    m_ticks[i] = x;
+    m_values[i] = value;
+    ++m_size;
+    return true;
+  }
+
+  /// @brief Remove the pairs with epochs before t; O(1) per pair removed.
+  /// @return The number of pairs removed.
+  std::size_t
+  evict_before(const datetime<S>& t) noexcept
+  {
+    const std::int64_t x = to_linear_ticks(t);
+    std::size_t k = 0;
+    while (k < m_size && m_ticks[slot(k)] < x) ++k;
+    drop_front(k);
+    return k;
+  }
+
+  /// @brief Remove the pairs with epochs more than window before the newest
+  ///        epoch, i.e. keep the window (newest - window, newest].
+  /// @return The number of pairs removed.
+  std::size_t
+  evict_older_than(S window) noexcept
+  {
+    if (!m_size) return 0;
+    const std::int64_t x = m_ticks[slot(m_size - 1)]
+      - static_cast<std::int64_t>(window.as_underlying_type());
+    std::size_t k = 0;
+    while (k < m_size && m_ticks[slot(k)] <= x) ++k;
+    drop_front(k);
+    return k;
+  }
+
+  /// @brief Remove the n oldest pairs (at most size()).
+  void
+  pop_front(std::size_t n = 1) noexcept
+  { drop_front(n < m_size ? n : m_size); }
+
+  /// @brief Position (0 being the oldest) of the first pair with an epoch not
+  ///        before t, or size() if there is none; O(log n).
+  std::size_t
+  lower_bound(const datetime<S>& t) const noexcept
+  {
+    const std::int64_t x = to_linear_ticks(t);
+    std::size_t lo = 0, len = m_size;
+    while (len) {
+      const std::size_t half = len / 2;
+      if (m_ticks[slot(lo + half)] < x) {
+        lo += half + 1;
+        len -= half + 1;
+      } else {
+        len = half;
+      }
+    }
+    return lo;
+  }
+
+  /// The epoch at position i (0 being the oldest; no bounds check).
+  datetime<S>
+  epoch(std::size_t i) const noexcept
+  { return from_linear_ticks<S>(m_ticks[slot(i)]); }
+
+  /// The value at position i (0 being the oldest; no bounds check).
+  T&
+  operator[](std::size_t i) noexcept
+  { return m_values[slot(i)]; }
+
+  /// The value at position i (0 being the oldest; no bounds check).
+  const T&
+  operator[](std::size_t i) const noexcept
+  { return m_values[slot(i)]; }
+
+  /// Number of pairs held.
+  std::size_t
+  size() const noexcept
+  { return m_size; }
+
+  /// Maximum number of pairs.
+  std::size_t
+  capacity() const noexcept
+  { return m_capacity; }
+
+  /// Is the buffer empty?
+  bool
+  empty() const noexcept
+  { return !m_size; }
+
+  /// Is the buffer full?
+  bool
+  full() const noexcept
+  { return m_size == m_capacity; }
+
+  /// Remove all pairs.
+  void
+  clear() noexcept
+  { m_head = m_size = 0; }
+
+private:
+  /// Validate the capacity and allocate the ticks array.
+  static std::int64_t*
+  check_capacity(std::size_t capacity)
+  {
+    if (!capacity)
+      throw std::invalid_argument("epoch_ring: capacity must be positive");
+    return new std::int64_t[capacity];
+  }
+
+  /// Wrap a position in [0, 2*capacity) to the storage.
+  std::size_t
+  wrap(std::size_t i) const noexcept
+  { return (i >= m_capacity) ? i - m_capacity : i; }
+
+  /// Storage slot of the i-th (oldest first) pair.
+  std::size_t
+  slot(std::size_t i) const noexcept
+  { return wrap(m_head + i); }
+
+  /// Drop the k (<= size()) oldest pairs.
+  void
+  drop_front(std::size_t k) noexcept
+  {
+    m_head = wrap(m_head + k);
+    m_size -= k;
+  }
+
+  std::unique_ptr<std::int64_t[]> m_ticks;    ///< epochs, in linear ticks
+  std::unique_ptr<T[]>            m_values;   ///< values
+  std::size_t                     m_capacity; ///< storage size
+  std::size_t                     m_head;     ///< slot of the oldest pair
+  std::size_t                     m_size;     ///< number of pairs
+};// epoch_ring
+
+/// @brief A bounded, lock-free queue of (epoch, value) pairs, for exactly one
+///        producer and one consumer thread.
+///
+/// The producer only writes the tail index and the consumer only writes the
+/// head index (each on its own cache line); publication uses
+/// acquire/release ordering.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+/// @tparam T The type of the values (must be default-constructible and
+///           copy-assignable).
+template<typename S, typename T,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class spsc_epoch_queue
+{
+public:
+  /// @brief A queue holding (at least) capacity pairs; the capacity is
+  ///        rounded up to a power of 2.
+  /// @throw std::invalid_argument if the capacity is zero.
+  explicit
+  spsc_epoch_queue(std::size_t capacity)
+    : m_mask{round_capacity(capacity) - 1},
+      m_ticks{new std::int64_t[m_mask + 1]},
+      m_values{new T[m_mask + 1]},
+      m_head{0},
+      m_tail{0}
+  {}
+
+  /// @brief Append a pair (producer thread only).
+  /// @return false if the queue is full.
+  bool
+  try_push(const datetime<S>& t, const T& value)
+  {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) > m_mask) return false;
+    m_ticks[tail & m_mask] = to_linear_ticks(t);
+    m_values[tail & m_mask] = value;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Remove the oldest pair (consumer thread only).
+  /// @return false if the queue is empty.
+  bool
+  try_pop(datetime<S>& t, T& value)
+  {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire)) return false;
+    t = from_linear_ticks<S>(m_ticks[head & m_mask]);
+    value = m_values[head & m_mask];
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Number of pairs held (exact only when called from a thread while
+  ///        the other one is idle).
+  std::size_t
+  size() const noexcept
+  {
+    return m_tail.load(std::memory_order_acquire)
+      - m_head.load(std::memory_order_acquire);
+  }
+
+  /// Maximum number of pairs.
+  std::size_t
+  capacity() const noexcept
+  { return m_mask + 1; }
+
+private:
+  /// Validate the capacity and round it up to a power of 2.
+  static std::size_t
+  round_capacity(std::size_t capacity)
+  {
+    if (!capacity)
+      throw std::invalid_argument("spsc_epoch_queue: capacity must be "
+        "positive");
+    std::size_t c = 1;
+    while (c < capacity) c <<= 1;
+    return c;
+  }
+
+  std::size_t                     m_mask;   ///< capacity - 1
+  std::unique_ptr<std::int64_t[]> m_ticks;  ///< epochs, in linear ticks
+  std::unique_ptr<T[]>            m_values; ///< values
+  alignas(64) std::atomic<std::size_t> m_head; ///< next pair to pop
+  alignas(64) std::atomic<std::size_t> m_tail; ///< next slot to push to
+};// spsc_epoch_queue
+
+} // namespace ngpt
+
+#endif
@@ -0,0 +1,303 @@
+///
+/// @file  datetime_series.hpp
+///
+/// @brief A time series, i.e. values at (strictly increasing) epochs, with
+///        linear, Lagrange and Hermite interpolation at arbitrary epochs
+///        (e.g. SP3 orbits, clock products, meteorological series).
+///
+/// Finding the interval [t_i, t_i+1) that brackets a query epoch is the
+/// costly part of interpolation; a time_series::cursor remembers the last
+/// interval found, so that monotone queries (the usual case) only check it
+/// and its successor, i.e. cost O(1) instead of O(log n). Queries that do
+/// not take a cursor use the calling thread's cursor for the series (see
+/// time_series::thread_cursor), and the batch queries use a cursor over the
+/// whole batch.
+///
+/// Interpolation works on time differences (in seconds, as double) from the
+/// query epoch, computed from integer ticks, so no accuracy is lost for
+/// epochs far from MJD 0.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_SERIES__
+#define __NGPT_DT_SERIES__
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_binary.hpp"
+
+namespace ngpt
+{
+
+/// @enum interp_method
+/// Interpolation methods of ngpt::time_series.
+enum class interp_method
+: char
+{
+  linear,   ///< linear, between the two bracketing epochs
+  lagrange, ///< Lagrange polynomial over a window of nearby epochs
+  hermite   ///< cubic Hermite between the two bracketing epochs, using the
+            ///< rates (or finite-difference estimates of them)
+};// interp_method
+
+/// @brief Values of type T at strictly increasing epochs, with interpolation.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+/// @tparam T The type of the values; must be copyable, with T + T and
+///           T * double defined (e.g. double, or a vector type).
+template<typename S, typename T,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class time_series
+{
+public:
+  /// @brief Remembers the last bracketing interval of a series; keep one per
+  ///        thread (and per series).
+  struct cursor
+  {
+    std::size_t index = 0; ///< position of the left epoch of the interval
+  };
+
+  /// An empty series.
+  time_series() noexcept = default;
+
+  /// @brief A series of n values at n (strictly increasing) epochs.
+  /// @throw std::invalid_argument if the epochs are not strictly increasing.
+  time_series(const datetime<S>* epochs, const T* values, std::size_t n)
+  {
+    m_ticks.reserve(n);
+    m_values.reserve(n);
+    for (std::size_t i = 0; i < n; i++) push_back(epochs[i], values[i]);
+  }
+
+  /// @brief Append a value.
+  /// @throw std::invalid_argument if t is not after the last epoch, or if
+  ///        the previous values were given with rates.
+  void
+  push_back(const datetime<S>& t, const T& value)
+  {
+    if (!m_rates.empty())
+      throw std::invalid_argument("time_series: missing rate");
+    append(t, value);
+  }
+
+  /// @brief Append a value and its rate of change (per second), used by
+  ///        Hermite interpolation; either all values or none have rates.
+  /// @throw std::invalid_argument if t is not after the last epoch, or if
+  ///        the previous values were given without rates.
+  void
+  push_back(const datetime<S>& t, const T& value, const T& rate)
+  {
+    if (m_rates.size() != m_values.size())
+      throw std::invalid_argument("time_series: missing rate");
+    append(t, value);
+    m_rates.push_back(rate);
+  }
+
+  /// Number of values.
+  std::size_t
+  size() const noexcept
+  { return m_values.size(); }
+
+  /// Is the series empty?
+  bool
+  empty() const noexcept
+  { return m_values.empty(); }
+
+  /// The i-th epoch (no bounds check).
+  datetime<S>
+  epoch(std::size_t i) const noexcept
+  { return from_linear_ticks<S>(m_ticks[i]); }
+
+  /// The i-th value (no bounds check).
+  const T&
+  value(std::size_t i) const noexcept
+  { return m_values[i]; }
+
+  /// @brief Interpolate at epoch t, reusing (and updating) a cursor.
+  ///
+  /// @param[in] t      The epoch; must be within [first, last epoch]
+  /// @param[in] method The interpolation method
+  /// @param[in] c      The cursor
+  /// @param[in] order  Number of points of the Lagrange window (clamped to
+  ///                   [2, size()]); ignored by the other methods
+  /// @throw std::out_of_range if t is outside the series (or the series has
+  ///        less than 2 values).
+  T
+  interpolate(const datetime<S>& t, interp_method method, cursor& c,
+    std::size_t order = 10) const
+  {
+    const std::int64_t x = to_linear_ticks(t);
+    const std::size_t i = bracket(x, c);
+    switch (method) {
+      case interp_method::linear:
+        return linear(x, i);
+      case interp_method::lagrange:
+        return lagrange(x, i, order);
+      default:
+        return hermite(x, i);
+    }
+  }
+
+  /// @brief Interpolate at epoch t, using the calling thread's cursor.
+  /// @see time_series::interpolate(const datetime<S>&, interp_method,
+  ///      cursor&, std::size_t) const
+  T
+  interpolate(const datetime<S>& t, interp_method method,
+    std::size_t order = 10) const
+  { return interpolate(t, method, thread_cursor(), order); }
+
+  /// @brief The calling thread's cursor for this series.
+  ///
+  /// Each thread keeps a small cache of cursors, indexed by (a hash of) the
+  /// series' address, so that queries interleaved over several series (e.g.
+  /// one per satellite, or an orbit and a clock series) keep their own
+  /// cursors. Two series mapped to the same slot share it (and reset it
+  /// when they alternate).
+  cursor&
+  thread_cursor() const noexcept
+  {
+    struct slot
+    {
+      const time_series* owner = nullptr;
+      cursor             c;
+    };
+    thread_local slot cache[cursor_slots];
+    const std::size_t h = static_cast<std::size_t>(
+      (reinterpret_cast<std::uintptr_t>(this) * 0x9e3779b97f4a7c15ULL)
+      >> (64 - cursor_bits));
+    slot& s = cache[h];
+    if (s.owner != this) {
+      s.owner = this;
+      s.c = cursor{};
+    }
+    return s.c;
+  }
+
+  /// @brief Interpolate at n epochs (in one pass, with a single cursor;
+  ///        fastest if the epochs are sorted).
+  /// @throw std::out_of_range if an epoch is outside the series.
+  void
+  interpolate(const datetime<S>* t, std::size_t n, interp_method method,
+    T* out, std::size_t order = 10) const
+  {
+    cursor c;
+    for (std::size_t k = 0; k < n; k++)
+      out[k] = interpolate(t[k], method, c, order);
+  }
+
+private:
+  /// log2 of the number of (per-thread) cached cursors.
+  static constexpr int cursor_bits = 6;
+  /// Number of (per-thread) cached cursors.
+  static constexpr std::size_t cursor_slots = std::size_t{1} << cursor_bits;
+
+  /// Seconds per tick.
+  static constexpr double spt = 86400e0 / S::max_in_day;
+
+  /// Append a value (without rate).
+  void
+  append(const datetime<S>& t, const T& value)
+  {
+    const std::int64_t x = to_linear_ticks(t);
+    if (!m_ticks.empty() && x <= m_ticks.back())
+      throw std::invalid_argument("time_series: epochs must be strictly "
+        "increasing");
+    m_ticks.push_back(x);
+    m_values.push_back(value);
+  }
+
+  /// @brief Position i (in [0, size()-2]) such that x is in
+  ///        [ticks[i], ticks[i+1]]; tries the cursor and its successor
+  ///        before a binary search.
+  std::size_t
+  bracket(std::int64_t x, cursor& c) const
+  {
+    const std::size_t n = m_ticks.size();
+    if (n < 2 || x < m_ticks.front() || x > m_ticks.back())
+      throw std::out_of_range("time_series: epoch out of range");
+    std::size_t i = c.index;
+    if (i + 1 < n && m_ticks[i] <= x) {
+      if (x <= m_ticks[i+1]) return i;
+      if (i + 2 < n && x <= m_ticks[i+2]) return c.index = i + 1;
+    }
+    std::size_t lo = 0, hi = n - 1;
+    while (hi - lo > 1) {
+      const std::size_t mid = (lo + hi) / 2;
+      (m_ticks[mid] <= x) ? lo = mid : hi = mid;
+    }
+    return c.index = lo;
+  }
+
+  /// Linear interpolation in [ticks[i], ticks[i+1]].
+  T
+  linear(std::int64_t x, std::size_t i) const
+  {
+    const double s = static_cast<double>(x - m_ticks[i])
+                   / static_cast<double>(m_ticks[i+1] - m_ticks[i]);
+    return m_values[i] * (1e0 - s) + m_values[i+1] * s;
+  }
+
+  /// Lagrange interpolation over (up to) order points around i.
+  T
+  lagrange(std::int64_t x, std::size_t i, std::size_t order) const
+  {
+    const std::size_t n = m_ticks.size();
+    const std::size_t m = (order < 2) ? 2 : (order > n) ? n : order;
+    // window [first, first+m), centred on the bracketing interval
+    std::size_t first = (i + 1 >= m / 2) ? i + 1 - m / 2 : 0;
+    if (first + m > n) first = n - m;
+    T r {};
+    for (std::size_t j = first; j < first + m; j++) {
+      const double dj = (m_ticks[j] - x) * spt;
+      double w = 1e0;
+      for (std::size_t k = first; k < first + m; k++) {
+        if (k == j) continue;
+        const double dk = (m_ticks[k] - x) * spt;
+        w *= dk / (dk - dj);
+      }
+      r = (j == first) ? m_values[j] * w : r + m_values[j] * w;
+    }
+    return r;
+  }
+
+  /// Rate at epoch j; the stored one, or a finite-difference estimate.
+  T
+  rate(std::size_t j) const
+  {
+    if (!m_rates.empty()) return m_rates[j];
+    const std::size_t a = j ? j - 1 : j;
+    const std::size_t b = (j + 1 < m_ticks.size()) ? j + 1 : j;
+    return (m_values[b] + m_values[a] * -1e0)
+      * (1e0 / ((m_ticks[b] - m_ticks[a]) * spt));
+  }
+
+  /// Cubic Hermite interpolation in [ticks[i], ticks[i+1]].
+  T
+  hermite(std::int64_t x, std::size_t i) const
+  {
+    const double h = (m_ticks[i+1] - m_ticks[i]) * spt;
+    const double s = (x - m_ticks[i]) * spt / h;
+    const double s2 = s * s, s3 = s2 * s;
+    return m_values[i] * (2e0 * s3 - 3e0 * s2 + 1e0)
+      + rate(i) * ((s3 - 2e0 * s2 + s) * h)
+      + m_values[i+1] * (3e0 * s2 - 2e0 * s3)
+      + rate(i+1) * ((s3 - s2) * h);
+  }
+
+  std::vector<std::int64_t> m_ticks;  ///< epochs, in linear ticks
+  std::vector<T>            m_values; ///< values
+  std::vector<T>            m_rates;  ///< rates (empty if not given)
+};// time_series
+
+} // namespace ngpt
+
+#endif
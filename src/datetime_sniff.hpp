@@ -0,0 +1,450 @@
+///
+/// @file  datetime_sniff.hpp
+///
+/// @brief Auto-detection of the layout of epoch strings.
+///
+/// Given a few (sample) lines of an input file, infer the layout of the
+/// epochs they start with (i.e. year/month/day, year/day-of-year, year/month
+/// name/day, ISO-like 'T' separated), the delimiters used and the width of
+/// the fractional seconds; return a parser object bound to the detected
+/// layout. Parsing is then performed by the (fastest) specialized path for
+/// that layout, i.e. without trying each one of the ngpt::strptime_*
+/// functions in turn.
+///
+/// @code
+///   const char* lines[] = {"2015-12-30 12:09:30.000011 ...", ...};
+///   auto parser = ngpt::sniff_epoch_parser<ngpt::microseconds>(lines, 2);
+///   ngpt::datetime<ngpt::microseconds> t;
+///   auto res = parser.parse(line, line+std::strlen(line), t);
+/// @endcode
+///
+/// @see ngpt::datetime_format
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_SNIFF__
+#define __NGPT_DT_SNIFF__
+
+#include <cstring>
+#include <stdexcept>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "dtchars.hpp"
+#include "datetime_format.hpp"
+
+namespace ngpt
+{
+
+/// @struct epoch_format_info
+/// The description of an epoch layout, as detected by ngpt::sniff_epoch_line
+struct epoch_format_info
+{
+  epoch_layout layout {epoch_layout::ymd}; ///< layout of the date part
+  char date_del {'-'};      ///< date delimiter; ' ' means any run of blanks
+  char dt_sep {' '};        ///< date/time separator; 0 if there is no time
+  char time_del {':'};      ///< time delimiter; ' ' means any run of blanks
+  char frac_sep {'.'};      ///< separator of fractional seconds
+  int  time_fields {3};     ///< number of time fields, 2 (H,M) or 3 (H,M,S)
+  int  fraction_digits {0}; ///< number of fractional digits (max seen)
+  bool zulu {false};        ///< a trailing 'Z' follows the time
+};// epoch_format_info
+
+namespace dtchars
+{
+
+/// @struct sniffed_field
+/// Position of a field within a sniffed line.
+struct sniffed_field
+{
+  fmt_op op;  ///< what the field is
+  int    pos; ///< offset of the first char from the start of the line
+  int    len; ///< number of chars
+};// sniffed_field
+
+/// Skip a separator; any run of blanks is reported as ' '. Returns the
+/// separator character (or 0 if there is none, i.e. p points to an alnum
+/// character or to the end of the line).
+inline char
+sniff_separator(const char*& p, const char* last) noexcept
+{
+  if (p >= last) return 0;
+  if (is_blank(*p)) {
+    while (p < last && is_blank(*p)) ++p;
+    return ' ';
+  }
+  if (is_digit(*p) || is_alpha(*p)) return 0;
+  return *p++;
+}
+
+} // namespace dtchars
+
+/// @brief Infer the layout of an epoch string at the start of a line.
+///
+/// @param[in]  first  Start of the line
+/// @param[in]  last   End of the line (one past the last char)
+/// @param[out] info   The detected layout
+/// @param[out] fields If not nullptr, an array of (at least) 8 elements where
+///                    the position of each field within the line is stored.
+/// @param[out] nfields If not nullptr, the number of fields stored in fields.
+/// @return            Pointer to the first character after the epoch, or
+///                    nullptr if no layout could be inferred.
+///
+/// @note Anything after the epoch (e.g. data columns) is ignored.
+inline const char*
+sniff_epoch_line(const char* first, const char* last, epoch_format_info& info,
+  dtchars::sniffed_field* fields=nullptr, int* nfields=nullptr) noexcept
+{
+  using namespace dtchars;
+  dtchars::sniffed_field flds[8];
+  int nf = 0;
+  epoch_format_info inf;
+  const char* p = first;
+  const char* q;
+  long val;
+
+  // resolve a run of digits of at most maxw chars; record the field
+  auto digits = [&](fmt_op op, int maxw) -> bool {
+    q = parse_uint(p, last, maxw, val);
+    if (!q || (q < last && is_digit(*q))) return false;
+    flds[nf++] = sniffed_field{op, static_cast<int>(p-first),
+                               static_cast<int>(q-p)};
+    p = q;
+    return true;
+  };
+
+  while (p < last && is_blank(*p)) ++p;
+  if (!digits(fmt_op::year, 4) || flds[0].len != 4) return nullptr;
+  if (!(inf.date_del = sniff_separator(p, last))) return nullptr;
+
+  if (p < last && is_alpha(*p)) {
+    // year, month name, day of month
+    q = parse_month_name(p, last, val);
+    if (!q) return nullptr;
+    flds[nf++] = sniffed_field{fmt_op::month_name, static_cast<int>(p-first),
+                               static_cast<int>(q-p)};
+    p = q;
+    inf.layout = epoch_layout::yod;
+    if (!sniff_separator(p, last) || !digits(fmt_op::day_of_month, 2))
+      return nullptr;
+  } else {
+    // year, month, day of month or year, day of year
+    if (!digits(fmt_op::month, 3)) return nullptr;
+    const char* s = p;
+    const char  del = sniff_separator(s, last);
+    if (flds[1].len < 3 && del == inf.date_del && s < last && is_digit(*s)) {
+      p = s;
+      if (!digits(fmt_op::day_of_month, 2)) return nullptr;
+    } else {
+      flds[1].op = fmt_op::day_of_year;
+      inf.layout = epoch_layout::ydoy;
+    }
+  }
+
+  // date/time separator; a line may hold only a date
+  const char* date_end = p;
+  inf.dt_sep = sniff_separator(p, last);
+  if (inf.dt_sep == 0 && p < last && *p == 'T') {
+    inf.dt_sep = 'T';
+    ++p;
+    if (inf.layout == epoch_layout::ymd) inf.layout = epoch_layout::iso;
+  }
+  const int date_fields = nf;
+  bool has_time = (inf.dt_sep == ' ' || inf.dt_sep == 'T')
+               && digits(fmt_op::hours, 2);
+  if (has_time) {
+    const char* s = p;
+    inf.time_del = sniff_separator(s, last);
+    p = s;
+    has_time = inf.time_del && digits(fmt_op::minutes, 2);
+  }
+  if (!has_time) {
+    // only a date; ignore whatever follows
+    inf.dt_sep = 0;
+    inf.time_fields = 0;
+    if (inf.layout == epoch_layout::iso) inf.layout = epoch_layout::ymd;
+    nf = date_fields;
+    p = date_end;
+  } else {
+    inf.time_fields = 2;
+    const char* s = p;
+    if (sniff_separator(s, last) == inf.time_del && s < last && is_digit(*s)) {
+      p = s;
+      if (!digits(fmt_op::seconds, 2)) return nullptr;
+      inf.time_fields = 3;
+      if (p + 1 < last && (*p == '.' || *p == ',') && is_digit(p[1])) {
+        inf.frac_sep = *p++;
+        q = p;
+        while (q < last && is_digit(*q)) ++q;
+        flds[nf++] = sniffed_field{fmt_op::fraction, static_cast<int>(p-first),
+                                   static_cast<int>(q-p)};
+        inf.fraction_digits = static_cast<int>(q - p);
+        p = q;
+      }
+    }
+    if (p < last && *p == 'Z') {
+      inf.zulu = true;
+      ++p;
+    }
+  }
+
+  info = inf;
+  if (fields) std::memcpy(fields, flds, nf * sizeof(sniffed_field));
+  if (nfields) *nfields = nf;
+  return p;
+}
+
+/// @brief A datetime parser bound to a (detected) epoch layout.
+///
+/// Instances are normally created via ngpt::sniff_epoch_parser. Two parsing
+/// paths are available:
+/// - if all sniffed lines had their fields at fixed columns (the usual case
+///   for product files), fields are resolved directly from their (known)
+///   columns, with no scanning for delimiters, and
+/// - otherwise (or if a line does not conform to the fixed columns), via a
+///   ngpt::datetime_format compiled for the detected layout.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class epoch_parser
+{
+public:
+  /// @brief Constructor from a layout description.
+  /// @throw std::invalid_argument if the layout cannot be translated to a
+  ///        ngpt::datetime_format (should not happen for sniffed layouts).
+  explicit
+  epoch_parser(const epoch_format_info& info)
+    : m_info{info},
+      m_fmt{make_format(info).str},
+      m_nfixed{0},
+      m_fixed_len{0}
+  {}
+
+  /// @brief Set the fixed columns of the fields.
+  ///
+  /// @param[in] fields The fields (as sniffed by ngpt::sniff_epoch_line)
+  /// @param[in] n      Number of fields; if 0, the fixed-column path is
+  ///                   disabled.
+  void
+  set_fixed_columns(const dtchars::sniffed_field* fields, int n) noexcept
+  {
+    m_nfixed = 0;
+    m_fixed_len = 0;
+    for (int i = 0; i < n && i < 8; i++) {
+      m_fixed[i] = fields[i];
+      m_fixed_len = std::max(m_fixed_len, fields[i].pos + fields[i].len);
+    }
+    m_nfixed = (n <= 8) ? n : 0;
+    if (m_nfixed && m_info.zulu) ++m_fixed_len;
+  }
+
+  /// The detected layout.
+  const epoch_format_info&
+  info() const noexcept
+  { return m_info; }
+
+  /// The compiled format used by the generic path.
+  const datetime_format<>&
+  format() const noexcept
+  { return m_fmt; }
+
+  /// Is the fixed-column path enabled?
+  bool
+  fixed_columns() const noexcept
+  { return m_nfixed > 0; }
+
+  /// @brief Parse an epoch from the character range [first, last).
+  ///
+  /// @return An std::from_chars_result, as in ngpt::datetime_format::parse.
+  std::from_chars_result
+  parse(const char* first, const char* last, datetime<S>& t) const noexcept
+  {
+    if (m_nfixed && last - first >= m_fixed_len) {
+      long fields[8] = {0, 1, 1, 1, 0, 0, 0, 0};
+      if (parse_fixed(first, last, fields)) {
+        const char* end = first + m_fixed_len;
+        return {end, dtchars::assemble_datetime(fields,
+                  m_info.layout == epoch_layout::ydoy, t)};
+      }
+    }
+    return m_fmt.parse(first, last, t);
+  }
+
+private:
+  /// A format string, built from a layout description.
+  struct format_string { char str[32]; };
+
+  /// Translate a layout description to a format string.
+  static format_string
+  make_format(const epoch_format_info& info) noexcept
+  {
+    format_string fs;
+    char* p = fs.str;
+    auto put = [&p](const char* s) { while (*s) *p++ = *s++; };
+    put("%Y");
+    *p++ = info.date_del;
+    if (info.layout == epoch_layout::ydoy) {
+      put("%j");
+    } else {
+      put(info.layout == epoch_layout::yod ? "%b" : "%m");
+      *p++ = info.date_del;
+      put("%d");
+    }
+    if (info.time_fields >= 2) {
+      *p++ = info.dt_sep;
+      put("%H");
+      *p++ = info.time_del;
+      put("%M");
+      if (info.time_fields == 3) {
+        *p++ = info.time_del;
+        put("%S");
+        if (info.fraction_digits) {
+          *p++ = info.frac_sep;
+          put("%f");
+        }
+      }
+      if (info.zulu) *p++ = 'Z';
+    }
+    *p = '\0';
+    return fs;
+  }
+
+  /// The separator expected before a field (' ' means blanks).
+  char
+  separator_before(fmt_op op) const noexcept
+  {
+    switch (op) {
+      case fmt_op::year:
+        return ' ';
+      case fmt_op::hours:
+        return m_info.dt_sep;
+      case fmt_op::minutes:
+      case fmt_op::seconds:
+        return m_info.time_del;
+      case fmt_op::fraction:
+        return m_info.frac_sep;
+      default:
+        return m_info.date_del;
+    }
+  }
+
+  /// Resolve the fields from their fixed columns; false if the line does
+  /// not conform (including a wrong separator between two fields).
+  bool
+  parse_fixed(const char* first, const char* last, long* fields)
+  const noexcept
+  {
+    constexpr int sdigits = dtchars::sec_digits<S>();
+    const char* prev = first;
+    for (int i = 0; i < m_nfixed; i++) {
+      const dtchars::sniffed_field& f = m_fixed[i];
+      const char* p = first + f.pos;
+      const char* end = p + f.len;
+      const char sep = separator_before(f.op);
+      for (; prev < p; ++prev)
+        if (sep == ' ' ? !dtchars::is_blank(*prev) : *prev != sep)
+          return false;
+      prev = end;
+      if (end < last && dtchars::is_digit(*end)) return false;
+      if (f.op == fmt_op::month_name) {
+        if (dtchars::parse_month_name(p, end, fields[1]) != end) return false;
+        continue;
+      }
+      long v = 0L;
+      for (; p < end; ++p) {
+        if (!dtchars::is_digit(*p)) return false;
+        v = v * 10L + (*p - '0');
+      }
+      if (f.op == fmt_op::fraction) {
+        v = (f.len <= sdigits) ? v * dtchars::pow10(sdigits - f.len)
+                               : v / dtchars::pow10(f.len - sdigits);
+      }
+      fields[fmt_field_index(f.op)] = v;
+    }
+    return !m_info.zulu || *prev == 'Z';
+  }
+
+  epoch_format_info       m_info;      ///< the layout
+  datetime_format<>       m_fmt;       ///< compiled format (generic path)
+  dtchars::sniffed_field  m_fixed[8];  ///< fixed columns of the fields
+  int                     m_nfixed;    ///< number of fixed fields (0=off)
+  int                     m_fixed_len; ///< chars of a fixed-columns epoch
+};// epoch_parser
+
+/// @brief Infer the epoch layout from a number of sample lines and return a
+///        parser bound to it.
+///
+/// Each line is sniffed independently (see ngpt::sniff_epoch_line); all of
+/// them must have the same layout. The width of the fractional seconds is the
+/// maximum seen. If all lines have their fields at the same columns, the
+/// returned parser uses the fixed-column path. Finally, all lines are parsed
+/// with the returned parser, to verify the result.
+///
+/// @tparam S Any class of second type.
+/// @param[in] lines An array of (null-terminated) sample lines
+/// @param[in] n     Number of lines in the array
+/// @return          A parser bound to the detected layout
+/// @throw           std::invalid_argument if the layout could not be
+///                  inferred, the lines have different layouts, or any of
+///                  the lines cannot be parsed with the detected layout.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  epoch_parser<S>
+  sniff_epoch_parser(const char* const* lines, std::size_t n)
+{
+  if (!n) throw std::invalid_argument("sniff_epoch_parser: no lines");
+
+  epoch_format_info info, linfo;
+  dtchars::sniffed_field fields[8], lfields[8];
+  int nf = 0, lnf = 0;
+  bool fixed = true;
+
+  for (std::size_t i = 0; i < n; i++) {
+    const char* line = lines[i];
+    if (!sniff_epoch_line(line, line+std::strlen(line), linfo, lfields, &lnf))
+      throw std::invalid_argument("sniff_epoch_parser: failed to infer layout"
+        " of line \"" + std::string(line) + "\"");
+    if (!i) {
+      info = linfo;
+      nf = lnf;
+      std::memcpy(fields, lfields, sizeof fields);
+      continue;
+    }
+    if (linfo.layout != info.layout || linfo.date_del != info.date_del
+     || linfo.dt_sep != info.dt_sep || linfo.time_fields != info.time_fields
+     || (info.time_fields && linfo.time_del != info.time_del)
+     || linfo.zulu != info.zulu)
+      throw std::invalid_argument("sniff_epoch_parser: inconsistent layout"
+        " in line \"" + std::string(line) + "\"");
+    if (linfo.fraction_digits > info.fraction_digits) {
+      info.fraction_digits = linfo.fraction_digits;
+      info.frac_sep = linfo.frac_sep;
+    }
+    fixed = fixed && (lnf == nf);
+    for (int j = 0; fixed && j < nf; j++)
+      fixed = lfields[j].op == fields[j].op && lfields[j].pos == fields[j].pos
+           && lfields[j].len == fields[j].len;
+  }
+
+  epoch_parser<S> parser {info};
+  if (fixed) parser.set_fixed_columns(fields, nf);
+
+  datetime<S> t;
+  for (std::size_t i = 0; i < n; i++) {
+    const char* line = lines[i];
+    if (parser.parse(line, line+std::strlen(line), t).ec != std::errc{})
+      throw std::invalid_argument("sniff_epoch_parser: failed to parse line"
+        " \"" + std::string(line) + "\" with the detected layout");
+  }
+  return parser;
+}
+
+} // namespace ngpt
+
+#endif
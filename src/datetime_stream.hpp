@@ -0,0 +1,360 @@
+///
+/// @file  datetime_stream.hpp
+///
+/// @brief Stream (i.e. iostream) operators for ngpt::datetime and
+///        ngpt::datetime_interval.
+///
+/// Epochs are formatted into a small buffer on the stack (see the to_chars_*
+/// functions in datetime_write.hpp) and written with a single call to
+/// std::ostream::write; when reading, characters are taken directly from the
+/// stream buffer. No std::string is created in either direction.
+///
+/// The layout and the number of fractional digits are selected per stream,
+/// via the ngpt::epoch_io manipulator (the setting is sticky, i.e. it holds
+/// until changed):
+/// @code
+///   std::cout << t;                                     // 2015-12-30 02:09:59.999996
+///   std::cout << ngpt::epoch_io(ngpt::epoch_layout::ydoy, 3) << t;
+///                                                       // 2015-364 02:09:59.999
+///   std::cin >> ngpt::epoch_io(ngpt::epoch_layout::iso) >> t;
+/// @endcode
+/// The default layout is epoch_layout::ymd, with as many fractional digits as
+/// the precision of the second type. The date delimiters are the defaults of
+/// the to_chars_* functions, i.e. '-' for the ymd and ydoy layouts and ' ' for
+/// yod; epoch_layout::iso writes YYYY-MM-DDTHH:MM:SS[.f] and reads anything
+/// ngpt::parse_iso8601 accepts.
+///
+/// When reading, the fractional seconds are optional and any number of
+/// digits is accepted (truncated to the precision of the datetime). On
+/// failure the failbit is set and the datetime is left unchanged.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_STREAM__
+#define __NGPT_DT_STREAM__
+
+#include <istream>
+#include <ostream>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "dtchars.hpp"
+#include "datetime_format.hpp"
+#include "datetime_write.hpp"
+#include "datetime_iso.hpp"
+
+namespace ngpt
+{
+
+/// @struct epoch_io_format
+/// The stream setting installed by the ngpt::epoch_io manipulator.
+struct epoch_io_format
+{
+  epoch_layout layout; ///< the layout of epochs
+  int          digits; ///< fractional digits, or -1 for the precision of S
+};// epoch_io_format
+
+/// @brief Manipulator selecting the layout and fractional digits used by the
+///        stream operators of ngpt::datetime.
+///
+/// @param[in] layout The layout
+/// @param[in] digits Number of fractional seconds digits (when writing),
+///                   clamped to [0,9]; -1 means the precision of the second
+///                   type.
+inline epoch_io_format
+epoch_io(epoch_layout layout, int digits=-1) noexcept
+{
+  return epoch_io_format{layout, digits < -1 ? -1 : (digits > 9 ? 9 : digits)};
+}
+
+namespace dtchars
+{
+
+/// The (std::ios_base::iword) index holding the ngpt::epoch_io setting.
+inline int
+epoch_io_index() noexcept
+{
+  static const int index = std::ios_base::xalloc();
+  return index;
+}
+
+/// @brief The ngpt::epoch_io setting of a stream.
+///
+/// The setting is stored in a single iword as 1 + layout + 16*(digits+1), so
+/// that the value 0 (of streams never manipulated) means the default.
+inline epoch_io_format
+get_epoch_io(std::ios_base& s)
+{
+  const long v = s.iword(epoch_io_index());
+  if (!v) return epoch_io_format{epoch_layout::ymd, -1};
+  return epoch_io_format{static_cast<epoch_layout>((v - 1) % 16),
+                         static_cast<int>((v - 1) / 16) - 1};
+}
+
+/// @brief Format an epoch in the given layout.
+/// @see ngpt::to_chars_ymd_hms for the returned value.
+template<typename S>
+  std::to_chars_result
+  to_chars_epoch(char* first, char* last, const datetime<S>& t,
+    epoch_layout layout, int digits) noexcept
+{
+  switch (layout) {
+    case epoch_layout::ydoy:
+      return to_chars_ydoy_hms(first, last, t, '-', digits);
+    case epoch_layout::yod:
+      return to_chars_yod_hms(first, last, t, ' ', digits);
+    default:
+      break;
+  }
+  auto res = to_chars_ymd_hms(first, last, t, '-', digits);
+  if (layout == epoch_layout::iso && res.ec == std::errc{}) {
+    // the (only) blank separates the date from the time
+    char* p = first;
+    while (*p != ' ') ++p;
+    *p = 'T';
+  }
+  return res;
+}
+
+/// @brief Write a buffer to a stream (in one call), padded to the stream's
+///        width with its fill character; the width is then reset.
+inline std::ostream&
+write_padded(std::ostream& os, const char* buf, std::streamsize n)
+{
+  const std::streamsize w = os.width();
+  os.width(0);
+  const bool left =
+    (os.flags() & std::ios_base::adjustfield) == std::ios_base::left;
+  if (!left) for (std::streamsize i = n; i < w; i++) os.put(os.fill());
+  os.write(buf, n);
+  if (left) for (std::streamsize i = n; i < w; i++) os.put(os.fill());
+  return os;
+}
+
+/// @brief Extract (at most cap) characters of ntokens blank-separated tokens
+///        from a stream buffer.
+///
+/// Runs of blanks between tokens are stored as a single ' '; extraction
+/// stops before the first blank following the last token, at any other
+/// whitespace character (e.g. a newline) or at the end of the input (in
+/// which case eof is set).
+///
+/// @return The number of characters stored, or cap + 1 if the tokens do not
+///         fit in the buffer.
+inline std::size_t
+extract_tokens(std::streambuf* sb, char* buf, std::size_t cap, int ntokens,
+  bool& eof)
+{
+  using traits = std::char_traits<char>;
+  std::size_t n = 0;
+  bool in_token = false;
+  eof = false;
+  for (int c = sb->sgetc();; c = sb->snextc()) {
+    if (traits::eq_int_type(c, traits::eof())) {
+      eof = true;
+      break;
+    }
+    const char ch = traits::to_char_type(c);
+    if (is_blank(ch)) {
+      if (in_token) {
+        in_token = false;
+        if (!--ntokens) break;
+        if (n == cap) return cap + 1;
+        buf[n++] = ' ';
+      }
+    } else if (ch == '\n' || ch == '\r' || ch == '\v' || ch == '\f') {
+      break;
+    } else {
+      in_token = true;
+      if (n == cap) return cap + 1;
+      buf[n++] = ch;
+    }
+  }
+  return n;
+}
+
+/// @brief Resolve a time of day, as HH:MM:SS[.f...], to ticks of S.
+/// @return Pointer to the first character not interpreted, or nullptr on
+///         error (including fields out of range).
+template<typename S>
+  const char*
+  parse_time_of_day(const char* first, const char* last, long& ticks) noexcept
+{
+  long hms[3] = {0L, 0L, 0L}, frac = 0L;
+  const char* p = first;
+  for (int i = 0; i < 3; i++) {
+    if (i && (p >= last || *p++ != ':')) return nullptr;
+    if (!(p = parse_uint(p, last, 2, hms[i]))) return nullptr;
+  }
+  if (p < last && *p == '.')
+    if (!(p = parse_fraction(p + 1, last, sec_digits<S>(), frac)))
+      return nullptr;
+  if (hms[0] > 23 || hms[1] > 59 || hms[2] > 60) return nullptr;
+  ticks = ((hms[0] * 60L + hms[1]) * 60L + hms[2])
+    * S::template sec_factor<long>() + frac;
+  return p;
+}
+
+/// @brief Parse an epoch in the given layout, from [first, last).
+///
+/// The fractional seconds are optional; the whole range must be consumed.
+template<typename S>
+  bool
+  parse_epoch(const char* first, const char* last, epoch_layout layout,
+    datetime<S>& t) noexcept
+{
+  constexpr datetime_format<> ymd_fmt  {"%Y-%m-%d %H:%M:%S"};
+  constexpr datetime_format<> ydoy_fmt {"%Y-%j %H:%M:%S"};
+  constexpr datetime_format<> yod_fmt  {"%Y %b %d %H:%M:%S"};
+  datetime<S> tmp;
+  std::from_chars_result res;
+  switch (layout) {
+    case epoch_layout::iso:
+      res = parse_iso8601(first, last, tmp);
+      if (res.ec != std::errc{} || res.ptr != last) return false;
+      t = tmp;
+      return true;
+    case epoch_layout::ydoy:
+      res = ydoy_fmt.parse(first, last, tmp);
+      break;
+    case epoch_layout::yod:
+      res = yod_fmt.parse(first, last, tmp);
+      break;
+    default:
+      res = ymd_fmt.parse(first, last, tmp);
+  }
+  if (res.ec != std::errc{}) return false;
+  const char* p = res.ptr;
+  if (p < last && *p == '.') {
+    long frac = 0L;
+    p = parse_fraction(p + 1, last, sec_digits<S>(), frac);
+    if (!p) return false;
+    tmp.add_seconds(S{static_cast<typename S::underlying_type>(frac)});
+  }
+  if (p != last) return false;
+  t = tmp;
+  return true;
+}
+
+} // namespace dtchars
+
+/// @brief Install an epoch_io setting to an output stream.
+inline std::ostream&
+operator<<(std::ostream& os, epoch_io_format f)
+{
+  os.iword(dtchars::epoch_io_index()) =
+    1L + static_cast<long>(f.layout) + 16L * (f.digits + 1);
+  return os;
+}
+
+/// @brief Install an epoch_io setting to an input stream.
+inline std::istream&
+operator>>(std::istream& is, epoch_io_format f)
+{
+  is.iword(dtchars::epoch_io_index()) =
+    1L + static_cast<long>(f.layout) + 16L * (f.digits + 1);
+  return is;
+}
+
+/// @brief Write a datetime to an output stream, in the layout selected via
+///        ngpt::epoch_io (the stream's width and fill are respected).
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::ostream&
+  operator<<(std::ostream& os, const datetime<S>& t)
+{
+  std::ostream::sentry sentry {os};
+  if (!sentry) return os;
+  const epoch_io_format f = dtchars::get_epoch_io(os);
+  char buf[64];
+  auto res = dtchars::to_chars_epoch(buf, buf + sizeof buf, t, f.layout,
+    f.digits < 0 ? dtchars::sec_digits<S>() : f.digits);
+  if (res.ec != std::errc{}) {
+    os.setstate(std::ios_base::failbit);
+    return os;
+  }
+  return dtchars::write_padded(os, buf, res.ptr - buf);
+}
+
+/// @brief Write a datetime_interval to an output stream, as
+///        Dd HH:MM:SS[.f...] (see ngpt::to_chars_interval).
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::ostream&
+  operator<<(std::ostream& os, const datetime_interval<S>& d)
+{
+  std::ostream::sentry sentry {os};
+  if (!sentry) return os;
+  char buf[64];
+  auto res = to_chars_interval(buf, buf + sizeof buf, d);
+  return dtchars::write_padded(os, buf, res.ptr - buf);
+}
+
+/// @brief Read a datetime from an input stream, in the layout selected via
+///        ngpt::epoch_io; leading whitespace is skipped.
+///
+/// On failure the failbit is set and t is left unchanged.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::istream&
+  operator>>(std::istream& is, datetime<S>& t)
+{
+  std::istream::sentry sentry {is};
+  if (!sentry) return is;
+  const epoch_layout layout = dtchars::get_epoch_io(is).layout;
+  const int ntokens = (layout == epoch_layout::iso) ? 1
+                    : (layout == epoch_layout::yod) ? 4 : 2;
+  char buf[64];
+  bool eof;
+  const std::size_t n = dtchars::extract_tokens(is.rdbuf(), buf, sizeof buf,
+    ntokens, eof);
+  std::ios_base::iostate state = eof ? std::ios_base::eofbit
+                                     : std::ios_base::goodbit;
+  if (n > sizeof buf || !dtchars::parse_epoch(buf, buf + n, layout, t))
+    state |= std::ios_base::failbit;
+  is.setstate(state);
+  return is;
+}
+
+/// @brief Read a datetime_interval, written as [-]Dd HH:MM:SS[.f...], from
+///        an input stream; leading whitespace is skipped.
+///
+/// On failure the failbit is set and d is left unchanged.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::istream&
+  operator>>(std::istream& is, datetime_interval<S>& d)
+{
+  std::istream::sentry sentry {is};
+  if (!sentry) return is;
+  char buf[64];
+  bool eof;
+  const std::size_t n = dtchars::extract_tokens(is.rdbuf(), buf, sizeof buf,
+    2, eof);
+  std::ios_base::iostate state = eof ? std::ios_base::eofbit
+                                     : std::ios_base::goodbit;
+  const char* last = buf + (n > sizeof buf ? 0 : n);
+  long days = 0L, ticks = 0L;
+  const bool neg = (last > buf && buf[0] == '-');
+  const char* p = dtchars::parse_uint(buf + neg, last, 18, days);
+  if (p && p + 1 < last && p[0] == 'd' && p[1] == ' '
+    && dtchars::parse_time_of_day<S>(p + 2, last, ticks) == last) {
+    const datetime_interval<S> a {modified_julian_day{days},
+      S{static_cast<typename S::underlying_type>(ticks)}};
+    d = neg ? datetime_interval<S>{} - a : a;
+  } else {
+    state |= std::ios_base::failbit;
+  }
+  is.setstate(state);
+  return is;
+}
+
+} // namespace ngpt
+
+#endif
@@ -0,0 +1,262 @@
+///
+/// @file  datetime_vector.hpp
+///
+/// @brief A structure-of-arrays container of ngpt::datetime.
+///
+/// A std::vector<datetime<S>> interleaves the MJD and the seconds of day of
+/// its elements; datetime_vector keeps them in two separate, contiguous
+/// arrays (aligned to cache lines), so that kernels working on one (or both)
+/// of them process consecutive integers and can be vectorized. Elements are
+/// accessed via proxy references, which convert to (and can be assigned
+/// from) datetime<S>.
+///
+/// The batch kernels of datetime_batch.hpp accept datetime_vector instances
+/// directly.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __NGPT_DT_VECTOR__
+#define __NGPT_DT_VECTOR__
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+
+namespace ngpt
+{
+
+namespace dtchars
+{
+
+/// @brief An allocator of memory aligned to Align bytes.
+template<typename T, std::size_t Align = 64>
+  struct aligned_allocator
+{
+  using value_type = T;
+
+  template<typename U>
+    struct rebind
+  { using other = aligned_allocator<U, Align>; };
+
+  aligned_allocator() noexcept = default;
+
+  template<typename U>
+    aligned_allocator(const aligned_allocator<U, Align>&) noexcept
+  {}
+
+  T*
+  allocate(std::size_t n)
+  {
+    return static_cast<T*>(::operator new(n * sizeof(T),
+      std::align_val_t{Align}));
+  }
+
+  void
+  deallocate(T* p, std::size_t) noexcept
+  { ::operator delete(p, std::align_val_t{Align}); }
+
+  template<typename U>
+    bool
+    operator==(const aligned_allocator<U, Align>&) const noexcept
+  { return true; }
+
+  template<typename U>
+    bool
+    operator!=(const aligned_allocator<U, Align>&) const noexcept
+  { return false; }
+};// aligned_allocator
+
+} // namespace dtchars
+
+/// @brief A structure-of-arrays container of datetime<S> (see the file
+///        description).
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  class datetime_vector
+{
+public:
+  /// Type of the MJD array elements.
+  using mjd_type = modified_julian_day::underlying_type;
+  /// Type of the seconds (of day) array elements.
+  using sec_type = typename S::underlying_type;
+
+  /// @brief Proxy reference to an element.
+  class reference
+  {
+  public:
+    /// The referenced datetime.
+    operator datetime<S>() const noexcept
+    { return datetime<S>{modified_julian_day{*m_mjd}, S{*m_sec}}; }
+
+    /// Assign a datetime (expected to be normalized).
+    reference&
+    operator=(const datetime<S>& t) noexcept
+    {
+      *m_mjd = t.mjd().as_underlying_type();
+      *m_sec = t.sec().as_underlying_type();
+      return *this;
+    }
+
+    /// Assign the element referenced by another proxy.
+    reference&
+    operator=(const reference& r) noexcept
+    {
+      *m_mjd = *r.m_mjd;
+      *m_sec = *r.m_sec;
+      return *this;
+    }
+
+    /// The MJD of the element.
+    modified_julian_day
+    mjd() const noexcept
+    { return modified_julian_day{*m_mjd}; }
+
+    /// The seconds of day of the element.
+    S
+    sec() const noexcept
+    { return S{*m_sec}; }
+
+  private:
+    friend class datetime_vector;
+
+    reference(mjd_type* m, sec_type* s) noexcept
+      : m_mjd{m},
+        m_sec{s}
+    {}
+
+    mjd_type* m_mjd; ///< the element's MJD
+    sec_type* m_sec; ///< the element's seconds of day
+  };// reference
+
+  /// An empty vector.
+  datetime_vector() noexcept = default;
+
+  /// A vector of n epochs (at MJD 0).
+  explicit
+  datetime_vector(std::size_t n)
+    : m_mjd(n, 0),
+      m_sec(n, 0)
+  {}
+
+  /// A vector holding (a copy of) an array of n epochs (AoS to SoA).
+  datetime_vector(const datetime<S>* epochs, std::size_t n)
+  { assign(epochs, n); }
+
+  /// Replace the contents with (a copy of) an array of n epochs.
+  void
+  assign(const datetime<S>* epochs, std::size_t n)
+  {
+    m_mjd.resize(n);
+    m_sec.resize(n);
+    for (std::size_t i = 0; i < n; i++) {
+      m_mjd[i] = epochs[i].mjd().as_underlying_type();
+      m_sec[i] = epochs[i].sec().as_underlying_type();
+    }
+  }
+
+  /// Copy the epochs to an array of (at least) size() datetimes (SoA to AoS).
+  void
+  to_aos(datetime<S>* out) const noexcept
+  {
+    for (std::size_t i = 0; i < size(); i++)
+      out[i] = datetime<S>{modified_julian_day{m_mjd[i]}, S{m_sec[i]}};
+  }
+
+  /// The epochs as a std::vector<datetime<S>> (SoA to AoS).
+  std::vector<datetime<S>>
+  to_aos() const
+  {
+    std::vector<datetime<S>> v(size());
+    to_aos(v.data());
+    return v;
+  }
+
+  /// Number of epochs.
+  std::size_t
+  size() const noexcept
+  { return m_mjd.size(); }
+
+  /// Is the vector empty?
+  bool
+  empty() const noexcept
+  { return m_mjd.empty(); }
+
+  /// Reserve room for n epochs.
+  void
+  reserve(std::size_t n)
+  {
+    m_mjd.reserve(n);
+    m_sec.reserve(n);
+  }
+
+  /// Resize to n epochs (new ones are at MJD 0).
+  void
+  resize(std::size_t n)
+  {
+    m_mjd.resize(n, 0);
+    m_sec.resize(n, 0);
+  }
+
+  /// Remove all epochs.
+  void
+  clear() noexcept
+  {
+    m_mjd.clear();
+    m_sec.clear();
+  }
+
+  /// Append an epoch (expected to be normalized).
+  void
+  push_back(const datetime<S>& t)
+  {
+    m_mjd.push_back(t.mjd().as_underlying_type());
+    m_sec.push_back(t.sec().as_underlying_type());
+  }
+
+  /// Proxy reference to the i-th epoch (no bounds check).
+  reference
+  operator[](std::size_t i) noexcept
+  { return reference{m_mjd.data() + i, m_sec.data() + i}; }
+
+  /// The i-th epoch (no bounds check).
+  datetime<S>
+  operator[](std::size_t i) const noexcept
+  { return datetime<S>{modified_julian_day{m_mjd[i]}, S{m_sec[i]}}; }
+
+  /// The MJD array.
+  mjd_type*
+  mjd_data() noexcept
+  { return m_mjd.data(); }
+
+  /// The MJD array (const).
+  const mjd_type*
+  mjd_data() const noexcept
+  { return m_mjd.data(); }
+
+  /// The seconds of day array (in ticks of S).
+  sec_type*
+  sec_data() noexcept
+  { return m_sec.data(); }
+
+  /// The seconds of day array (const).
+  const sec_type*
+  sec_data() const noexcept
+  { return m_sec.data(); }
+
+private:
+  std::vector<mjd_type, dtchars::aligned_allocator<mjd_type>> m_mjd; ///< MJDs
+  std::vector<sec_type, dtchars::aligned_allocator<sec_type>> m_sec; ///< secs
+};// datetime_vector
+
+} // namespace ngpt
+
+#endif
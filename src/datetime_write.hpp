@@ -3,6 +3,13 @@
 ///
 /// @brief Function to format ngpt::datetime objects as strings
 ///
+/// The to_chars_* functions write into a caller-supplied buffer and follow
+/// the conventions of std::to_chars, i.e. they do not allocate, do not throw
+/// and report errors via an std::errc code. The fractional seconds are
+/// written exactly, from the integral ticks of the datetime (no floating
+/// point arithmetic is involved). The strftime_* functions are convinience
+/// wrappers returning an std::string.
+///
 /// @see ngpt::datetime
 ///
 /// @author xanthos
@@ -13,74 +20,170 @@
 #ifndef __NGPT_DT_WRITERS__
 #define __NGPT_DT_WRITERS__
 
-#include <iostream>
-#include <iomanip>
-#include <sstream>
+#include <charconv>
 #include <stdexcept>
+#include <system_error>
+#include <string>
 #include "dtfund.hpp"
 #include "dtcalendar.hpp"
+#include "dtchars.hpp"
 
 namespace ngpt {
 
-/// Format a double to an std::string using std::fixed and a precision on
-/// n digits
-inline std::string
-_d2s_(double d, int n=2) noexcept
+/// @brief Format as YYYY-MM-DD HH:MM:SS[.f...]
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+/// @param[in] first  Start of the buffer to write to
+/// @param[in] last   End of the buffer (one past the last char)
+/// @param[in] t      The datetime to format
+/// @param[in] del    The date delimiter
+/// @param[in] digits Number of fractional seconds digits, in the range [0,9];
+///                   if 0 no fractional part is written. If less than the
+///                   precision of S, the seconds are truncated.
+/// @return An std::to_chars_result; on success, ptr points to one past the
+///         last character written and ec is std::errc{}. If the buffer is
+///         too small, ec is std::errc::value_too_large (and the contents of
+///         the buffer are unspecified); if digits is out of range, ec is
+///         std::errc::invalid_argument. No null character is written.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::to_chars_result
+  to_chars_ymd_hms(char* first, char* last, const datetime<S>& t,
+    char del='-', int digits=0) noexcept
+{
+  if (digits < 0 || digits > 9) return {last, std::errc::invalid_argument};
+  const ymd_date d {t.as_ymd()};
+  const long y = d.__year.as_underlying_type();
+  const int yw = dtchars::year_width(y);
+  if (last - first < yw + 7 + dtchars::time_width(digits))
+    return {last, std::errc::value_too_large};
+
+  char* p = dtchars::write_year(first, y, yw);
+  *p++ = del;
+  p = dtchars::write_2digits(p, d.__month.as_underlying_type());
+  *p++ = del;
+  p = dtchars::write_2digits(p, d.__dom.as_underlying_type());
+  *p++ = ' ';
+  return {dtchars::write_time<S>(p, t.sec_as_i(), digits), std::errc{}};
+}
+
+/// @brief Format as YYYY-DDD HH:MM:SS[.f...]
+///
+/// @see ngpt::to_chars_ymd_hms for the parameters and the returned value.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::to_chars_result
+  to_chars_ydoy_hms(char* first, char* last, const datetime<S>& t,
+    char del='-', int digits=0) noexcept
+{
+  if (digits < 0 || digits > 9) return {last, std::errc::invalid_argument};
+  const ydoy_date d {t.as_ydoy()};
+  const long y = d.__year.as_underlying_type();
+  const int yw = dtchars::year_width(y);
+  if (last - first < yw + 5 + dtchars::time_width(digits))
+    return {last, std::errc::value_too_large};
+
+  char* p = dtchars::write_year(first, y, yw);
+  *p++ = del;
+  p = dtchars::write_uint(p, d.__doy.as_underlying_type(), 3);
+  *p++ = ' ';
+  return {dtchars::write_time<S>(p, t.sec_as_i(), digits), std::errc{}};
+}
+
+/// @brief Format as YYYY OOO DD HH:MM:SS[.f...], where OOO is the month's
+///        short name, e.g. "Dec".
+///
+/// @see ngpt::to_chars_ymd_hms for the parameters and the returned value.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::to_chars_result
+  to_chars_yod_hms(char* first, char* last, const datetime<S>& t,
+    char del=' ', int digits=0) noexcept
 {
-  std::stringstream stream;
-  stream << std::fixed << std::setprecision(n) << d;
-  return stream.str();
+  if (digits < 0 || digits > 9) return {last, std::errc::invalid_argument};
+  const ymd_date d {t.as_ymd()};
+  const long y = d.__year.as_underlying_type();
+  const int yw = dtchars::year_width(y);
+  if (last - first < yw + 8 + dtchars::time_width(digits))
+    return {last, std::errc::value_too_large};
+
+  char* p = dtchars::write_year(first, y, yw);
+  *p++ = del;
+  std::memcpy(p, d.__month.short_name(), 3);
+  p += 3;
+  *p++ = del;
+  p = dtchars::write_2digits(p, d.__dom.as_underlying_type());
+  *p++ = ' ';
+  return {dtchars::write_time<S>(p, t.sec_as_i(), digits), std::errc{}};
 }
 
-/// Format a double to an std::string with a width of w chars
-inline std::string
-_i2s_(int i, int w=2) noexcept
+/// @brief Format a datetime_interval as Dd HH:MM:SS[.f...], with as many
+///        fractional digits as the precision of S (e.g. "3d 01:02:03.500").
+///
+/// Negative intervals are written in sign-magnitude form, e.g. -1 second is
+/// "-0d 00:00:01".
+///
+/// @return An std::to_chars_result; on success, ptr points to one past the
+///         last character written and ec is std::errc{}. If the buffer is
+///         too small, ec is std::errc::value_too_large.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  std::to_chars_result
+  to_chars_interval(char* first, char* last, const datetime_interval<S>& d)
+  noexcept
 {
-  std::stringstream stream;
-  stream << std::setfill('0') << std::setw(w) << i;
-  return stream.str();
+  constexpr int sdigits = dtchars::sec_digits<S>();
+  const bool neg = d.sign() < 0;
+  const datetime_interval<S> a = neg ? ngpt::abs(d) : d;
+  const unsigned long adays = a.days().as_underlying_type();
+  const int dw = dtchars::count_digits(adays);
+  if (last - first < neg + dw + 2 + dtchars::time_width(sdigits))
+    return {last, std::errc::value_too_large};
+
+  char* p = first;
+  if (neg) *p++ = '-';
+  p = dtchars::write_uint(p, adays, dw);
+  *p++ = 'd';
+  *p++ = ' ';
+  return {dtchars::write_time<S>(p, a.sec().as_underlying_type(), sdigits),
+          std::errc{}};
 }
 
-/// @brief Format as YYYY-MM-DD
+/// @brief Format as YYYY-MM-DD HH:MM:SS.fffff
 ///
-/// Read and return a date from a c-string of type: YYYY-MM-DD, where the 
-/// delimeters can be whatever (but something, i.e. two numbers must be 
-/// seperated by some char -- 20150930 is wrong --).
-/// Hours, minutes and seconds are set to 0.
-/// If the argument stop is passed, it will be set to the last character (of
-/// str) interpreted.
+/// The seconds are written with 5 fractional digits (truncated).
 ///
-/// @throw std::invalid_argument if the input string cannot be resolved.
+/// @see ngpt::to_chars_ymd_hms
+/// @throw std::runtime_error if the datetime cannot be formatted.
 template<typename T>
   std::string
   strftime_ymd_hmfs(const datetime<T>& t, char del='-')
 {
-  auto ymd  = t.as_ymd();
-  auto hmsf = t.as_hmsf();
-  
-  double secs = std::get<2>(hmsf).as_underlying_type() + 
-                std::get<3>(hmsf) / T::template sec_factor<double>();
-  
-  return _i2s_((ymd.__year).as_underlying_type(), 4) + del
-       + _i2s_((ymd.__month).as_underlying_type(), 2) + del
-       + _i2s_((ymd.__dom).as_underlying_type(), 2) + ' '
-       + _i2s_(std::get<0>(hmsf).as_underlying_type(),2) + ':'
-       + _i2s_(std::get<1>(hmsf).as_underlying_type(),2) + ':'
-       + _d2s_(secs, 5);
+  char buf[dtchars::max_year_width + 7 + dtchars::time_width(9)];
+  auto res = to_chars_ymd_hms(buf, buf + sizeof buf, t, del, 5);
+  if (res.ec != std::errc{})
+    throw std::runtime_error("strftime_ymd_hmfs: failed to format datetime");
+  return std::string(buf, res.ptr);
 }
+
+/// @brief Format as YYYY-MM-DD HH:MM:SS
+///
+/// @see ngpt::to_chars_ymd_hms
+/// @throw std::runtime_error if the datetime cannot be formatted.
 template<typename T>
   std::string
   strftime_ymd_hms(const datetime<T>& t, char del='-')
 {
-  auto ymd  = t.as_ymd();
-  auto hmsf = t.as_hmsf();
-  
-  return _i2s_((ymd.__year).as_underlying_type(), 4) + del
-       + _i2s_((ymd.__month).as_underlying_type(), 2) + del
-       + _i2s_((ymd.__dom).as_underlying_type(), 2) + ' '
-       + _i2s_(std::get<0>(hmsf).as_underlying_type(),2) + ':'
-       + _i2s_(std::get<1>(hmsf).as_underlying_type(),2) + ':'
-       + _i2s_(std::get<2>(hmsf).as_underlying_type(),2);
+  char buf[dtchars::max_year_width + 7 + dtchars::time_width(9)];
+  auto res = to_chars_ymd_hms(buf, buf + sizeof buf, t, del);
+  if (res.ec != std::errc{})
+    throw std::runtime_error("strftime_ymd_hms: failed to format datetime");
+  return std::string(buf, res.ptr);
 }
 
 } // namespace ngpt
@@ -16,6 +16,7 @@
 
 #include <cassert>
 #include "dtfund.hpp"
+#include "dtchars.hpp"
 
 #ifdef DEBUG
 # include <iostream>
@@ -26,14 +27,29 @@
 namespace ngpt
 {
 
+namespace dtchars
+{
+
+/// A 128-bit signed integer, for exact intermediates of interval arithmetic.
+__extension__ typedef __int128 int128;
+
+struct interval_access;
+
+} // namespace dtchars
+
 /// @brief A generic, templatized class to hold a datetime period/interval.
 ///
 /// A datetime_interval represents a time (datetime) interval or period, i.e.
 /// 5 days, 12 hours and 49 seconds. We assume a continuous time scale (no leap
 /// seconds are taken into consideration --this is only an interval not an
 /// actual datetime instance--).
-/// A datetime_interval instance can only have positive (or zero) values (for
-/// both its members).
+/// A datetime_interval is signed (e.g. d1.delta_date(d2) is negative if d1
+/// is before d2). It is kept in floor form: the day part can have any sign
+/// and the time part is always in [0, S::max_in_day), i.e. an interval of
+/// -1 second is -1 day plus 86399 seconds. This is the form produced by
+/// (branch-free) floor division of the total ticks, so it is unique and cheap
+/// to compute in (vectorized) batch kernels; the sign-magnitude form is only
+/// used for text (see ngpt::to_chars_interval).
 ///
 /// A datetime_interval instance has two fundamental parts (members):
 /// - a day part (i.e. holding the days), and 
@@ -46,19 +62,14 @@ namespace ngpt
 ///           ngpt::seconds, ngpt::milliseconds, ngpt::microseconds.
 ///
 ///
-/// @note  - Any instance of the class has two members, m_days an integer
-///          representing the (MJ) days and m_secs, an instance of type S, 
-///          representing the fractional day part. However, the parts may be
-///          mixed (!), that is if e.g. S is ngpt::seconds, the m_secs part may
-///          actualy have any value, including ones larger than 86400. That is
-///          to say that an instance can be constructed as:
+/// @note  Any instance of the class has two members, m_days an integer
+///        representing the (MJ) days and m_secs, an instance of type S,
+///        representing the fractional day part. The constructors accept parts
+///        of any sign and size and normalize them, e.g.
 ///        \code{.cpp}
 ///          datetime_interval<seconds> d {modified_julian_day(1), seconds(90000)};
+///          // d.days() == modified_julian_day(2), d.sec() == seconds(3600)
 ///        \endcode
-///          Should the user want the "normalization" of the instance (that is
-///          remove whole days from the m_secs part and add them to the m_days
-///          part), call the function datetime_interval::normalize().
-///          
 template<class S,
         typename = std::enable_if_t<S::is_of_sec_type>
         >
@@ -77,34 +88,37 @@ public:
   /// param[in] d  Number of days; a ngpt::modified_julian_day instance.
   /// param[in] s  Number of *seconds; an instance of type S
   ///
-  /// @note  A datetime_interval can only have positive values for its member
-  ///        variables. However, it can happen that the constructor gets a
-  ///        negative value for the seconds part, if the resulting time_interval
-  ///        is positive after normalization. E.g. datetime_interval(2, -123)
-  ///        is a valid time_interval; the constructor will first call the
-  ///        normalize function, which will transform the negative seconds to
-  ///        positive and remove whole days.
+  /// @note  The instance is normalized (to floor form), so both parts can
+  ///        have any sign and value; e.g. datetime_interval(2, -123) is two
+  ///        days minus 123 *seconds, and datetime_interval(0, -1) is -1 day
+  ///        plus S::max_in_day - 1 *seconds.
   explicit constexpr
   datetime_interval(modified_julian_day d, S s) noexcept
     : m_days{d},
       m_secs{s}
   {
     this->normalize();
-#ifdef USE_DATETIME_CHECKS
-    assert( m_days.as_underlying_type() >= 0
-         && m_secs.as_underlying_type() >= 0 );
-#endif
+  };
+
+  /// @brief Constructor from an amount of *seconds (of any sign), e.g. the
+  ///        result of ngpt::delta_sec.
+  explicit constexpr
+  datetime_interval(S s) noexcept
+    : m_days{0},
+      m_secs{s}
+  {
+    this->normalize();
   };
 
   /// Get the number of days of the instance.
   /// @return The number of days in the instance, as ngpt::modified_julian_day
-  modified_julian_day
+  constexpr modified_julian_day
   days() const noexcept
   { return m_days; }
     
   /// Get the number of *seconds (as type S) of the instance.
   /// @return The number of *seconds (as type S) of the instance.
-  S
+  constexpr S
   sec() const noexcept
   { return m_secs; }
     
@@ -116,23 +130,43 @@ public:
                              + m_secs.fractional_days();
   }
     
-  /// @brief Normalize a datetime_interval instance.
+  /// @brief The interval as an amount of *seconds (of type S), i.e. the
+  ///        inverse of datetime_interval(S); e.g. to compare with the results
+  ///        of ngpt::delta_sec.
+  /// @warning The result may overflow for very long intervals (see
+  ///          ngpt::max_days_allowed).
+  constexpr S
+  to_sec() const noexcept
+  {
+    return S{static_cast<typename S::underlying_type>(
+      m_days.as_underlying_type() * S::max_in_day
+      + m_secs.as_underlying_type())};
+  }
+
+  /// @brief The sign of the interval: -1, 0 or 1.
+  constexpr int
+  sign() const noexcept
+  {
+    // in floor form, the interval is negative iff the days are
+    const long d = m_days.as_underlying_type();
+    const bool s = m_secs.as_underlying_type() > 0;
+    return ((d > 0) | ((d == 0) & s)) - (d < 0);
+  }
+
+  /// @brief Normalize a datetime_interval instance (to floor form).
   ///
   /// Split the date and time parts such that the time part is always less
-  /// than one day (i.e. make it time-of-day) and positive (i.e.>=0).
-  /// Remove whole days of from the time part and add them to the date part.
+  /// than one day (i.e. make it time-of-day) and non-negative; whole days
+  /// are moved from the time part to the date part. The computation is a
+  /// floor division, without branches.
   constexpr void
   normalize() noexcept
   {
-    typename S::underlying_type secs { m_secs.as_underlying_type() };
-    m_days += secs / S::max_in_day;
-    m_secs  = secs % S::max_in_day;
-    // handle negative seconds
-    // @todo SHIT i don't want a loop in here! how could i avoid that??
-    if (m_secs < S{0}) {
-      --m_days;
-      m_secs = S{S::max_in_day} + m_secs;
-    }
+    const typename S::underlying_type secs { m_secs.as_underlying_type() };
+    const typename S::underlying_type r = secs % S::max_in_day;
+    const typename S::underlying_type neg = (r < 0);
+    m_days += secs / S::max_in_day - neg;
+    m_secs  = S{r + neg * S::max_in_day};
     return;
   }
 
@@ -166,27 +200,185 @@ public:
   operator!=(const datetime_interval& d) const noexcept
   { return !(this->operator==(d)); }
 
-  /// @todo wtf is this?? it needs checking
-  datetime_interval
-  operator/(int div) const noexcept
+  /// @brief Sum of two intervals (exact).
+  constexpr datetime_interval
+  operator+(const datetime_interval& d) const noexcept
+  { return from_ticks(ticks() + d.ticks()); }
+
+  /// @brief Difference of two intervals (exact); if d is longer than the
+  ///        instance, the result has negative days (and non-negative
+  ///        seconds, i.e. it is in floor form).
+  constexpr datetime_interval
+  operator-(const datetime_interval& d) const noexcept
+  { return from_ticks(ticks() - d.ticks()); }
+
+  /// @brief The interval times an integer (exact).
+  constexpr datetime_interval
+  operator*(long k) const noexcept
+  { return from_ticks(ticks() * k); }
+
+  /// @brief The integer times an interval (exact).
+  friend constexpr datetime_interval
+  operator*(long k, const datetime_interval& d) noexcept
+  { return d * k; }
+
+  /// @brief The interval divided by an integer (not zero), truncated to ticks
+  ///        of S (as the integer division); see ngpt::div for the remainder.
+  constexpr datetime_interval
+  operator/(long k) const noexcept
+  { return from_ticks(ticks() / k); }
+
+  /// @brief How many times an interval (not zero) fits in the instance, i.e.
+  ///        the ratio of the two intervals, truncated (as the integer
+  ///        division).
+  constexpr long
+  operator/(const datetime_interval& d) const noexcept
+  { return static_cast<long>(ticks() / d.ticks()); }
+
+  /// @brief The remainder of the ratio of two intervals, i.e.
+  ///        *this - (*this / d) * d.
+  constexpr datetime_interval
+  operator%(const datetime_interval& d) const noexcept
+  { return from_ticks(ticks() % d.ticks()); }
+
+  /// @brief Compare with any second type T (exact, with no casts); returns
+  ///        a negative number, zero or a positive number if the instance is
+  ///        shorter than, equal to or longer than t.
+  template<typename T,
+          typename = std::enable_if_t<T::is_of_sec_type>
+          >
+    constexpr int
+    compare(T t) const noexcept
   {
-    double d = static_cast<double>(m_days.as_underlying_type());
-    double i, f;
-    f = std::modf(d/div, &i);
-    auto new_mjd = static_cast<modified_julian_day::underlying_type>(i);
+    const dtchars::int128 a = ticks() * T::max_in_day;
+    const dtchars::int128 b = static_cast<dtchars::int128>(
+      t.as_underlying_type()) * S::max_in_day;
+    return (a > b) - (a < b);
+  }
+
+  /// Operator == with any second type.
+  template<typename T, typename = std::enable_if_t<T::is_of_sec_type>>
+    constexpr bool
+    operator==(T t) const noexcept
+  { return compare(t) == 0; }
+
+  /// Operator != with any second type.
+  template<typename T, typename = std::enable_if_t<T::is_of_sec_type>>
+    constexpr bool
+    operator!=(T t) const noexcept
+  { return compare(t) != 0; }
+
+  /// Operator < with any second type.
+  template<typename T, typename = std::enable_if_t<T::is_of_sec_type>>
+    constexpr bool
+    operator<(T t) const noexcept
+  { return compare(t) < 0; }
+
+  /// Operator <= with any second type.
+  template<typename T, typename = std::enable_if_t<T::is_of_sec_type>>
+    constexpr bool
+    operator<=(T t) const noexcept
+  { return compare(t) <= 0; }
+
+  /// Operator > with any second type.
+  template<typename T, typename = std::enable_if_t<T::is_of_sec_type>>
+    constexpr bool
+    operator>(T t) const noexcept
+  { return compare(t) > 0; }
+
+  /// Operator >= with any second type.
+  template<typename T, typename = std::enable_if_t<T::is_of_sec_type>>
+    constexpr bool
+    operator>=(T t) const noexcept
+  { return compare(t) >= 0; }
 
-    d = static_cast<double>(m_secs.as_underlying_type());
-    d = d/div + f*S::max_in_day;
-    auto new_sec = static_cast<typename S::underlying_type>(d);
+  /// @brief The interval as ticks of S, i.e. days*S::max_in_day + secs,
+  ///        exactly.
+  constexpr dtchars::int128
+  ticks() const noexcept
+  {
+    return static_cast<dtchars::int128>(m_days.as_underlying_type())
+      * S::max_in_day + m_secs.as_underlying_type();
+  }
 
-    return datetime_interval{modified_julian_day{new_mjd}, S{new_sec}};
+  /// @brief The interval of the given ticks of S (in floor form, i.e. with
+  ///        seconds in [0, S::max_in_day)).
+  static constexpr datetime_interval
+  from_ticks(dtchars::int128 t) noexcept
+  {
+    dtchars::int128 d = t / S::max_in_day;
+    dtchars::int128 r = t % S::max_in_day;
+    d -= (r < 0);
+    r += S::max_in_day * (r < 0);
+    datetime_interval i;
+    i.m_days = modified_julian_day{
+      static_cast<modified_julian_day::underlying_type>(d)};
+    i.m_secs = S{static_cast<typename S::underlying_type>(r)};
+    return i;
   }
 
 private:
+  friend struct dtchars::interval_access;
+
   modified_julian_day m_days;
   S                   m_secs;
 }; // end class datetime_interval
 
+namespace dtchars
+{
+
+/// @brief Build datetime_intervals from parts already in floor form, without
+///        normalizing them again; for batch kernels, which normalize without
+///        branches themselves.
+struct interval_access
+{
+  /// The interval of days and secs (the latter in [0, S::max_in_day)).
+  template<typename S>
+    static constexpr datetime_interval<S>
+    floor_form(long days, typename S::underlying_type secs) noexcept
+  {
+    datetime_interval<S> i;
+    i.m_days = modified_julian_day{days};
+    i.m_secs = S{secs};
+    return i;
+  }
+};// interval_access
+
+} // namespace dtchars
+
+/// @struct interval_div_t
+/// Quotient and remainder of ngpt::div.
+template<typename S>
+  struct interval_div_t
+{
+  datetime_interval<S> quot; ///< the quotient (truncated to ticks of S)
+  S                    rem;  ///< the remainder, in ticks of S
+};// interval_div_t
+
+/// @brief Divide an interval by an integer (not zero), exactly: d equals
+///        quot * k + rem (with the semantics of the integer division).
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  constexpr interval_div_t<S>
+  div(const datetime_interval<S>& d, long k) noexcept
+{
+  return interval_div_t<S>{d / k,
+    S{static_cast<typename S::underlying_type>(d.ticks() % k)}};
+}
+
+/// @brief The absolute value of an interval (see
+///        datetime_interval::operator-).
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  constexpr datetime_interval<S>
+  abs(const datetime_interval<S>& d) noexcept
+{
+  const dtchars::int128 t = d.ticks();
+  return datetime_interval<S>::from_ticks(t < 0 ? -t : t);
+}
+
 /// @brief A generic, templatized Date/Time class.
 ///
 /// A datetime instance has two fundamental parts (members):
@@ -734,26 +926,23 @@ public:
   as_hmsf() const noexcept
   { return m_sec.to_hmsf(); }
 
+  /// @brief Format as YYYY/MM/DD HH:MM:SS.fffffffff (i.e. with 9 fractional
+  ///        digits).
+  /// @see ngpt::to_chars_ymd_hms for allocation-free formatting.
   std::string
   stringify() const
   {
-    auto ymd { this->as_ymd() };
-    auto hms { this->as_hmsf() };
-    S st { std::get<3>(hms) };
-    double fsec { st.as_underlying_type() / S::template sec_factor<double>() };
-    std::ostringstream out;
-    out << std::fixed << std::setprecision(9) 
-        << (fsec + static_cast<double>(st.as_underlying_type()));
-
-    return std::string {
-                 std::to_string( ymd.__year.as_underlying_type() )
-         + "/" + std::to_string( ymd.__month.as_underlying_type() )
-         + "/" + std::to_string( ymd.__dom.as_underlying_type() )
-         + " " + std::to_string( std::get<0>(hms).as_underlying_type() )
-         + ":" + std::to_string( std::get<1>(hms).as_underlying_type() )
-         //+ ":" + std::to_string( std::get<2>(hms).as_underlying_type() )
-         + ":" + out.str()
-    };
+    char buf[dtchars::max_year_width + 7 + dtchars::time_width(9)];
+    const ymd_date ymd { this->as_ymd() };
+    const long y { ymd.__year.as_underlying_type() };
+    char* p = dtchars::write_year(buf, y, dtchars::year_width(y));
+    *p++ = '/';
+    p = dtchars::write_2digits(p, ymd.__month.as_underlying_type());
+    *p++ = '/';
+    p = dtchars::write_2digits(p, ymd.__dom.as_underlying_type());
+    *p++ = ' ';
+    p = dtchars::write_time<S>(p, m_sec.as_underlying_type(), 9);
+    return std::string(buf, p);
   }
 
 private:
@@ -863,6 +1052,11 @@ private:
 
 }; // end class datetime
 
+/// The more precise of two second types (i.e. the type of the result of
+/// ngpt::delta_sec for datetime<S1> and datetime<S2>).
+template<typename S1, typename S2>
+  using finer_sec_t =
+    std::conditional_t<(S1::max_in_day >= S2::max_in_day), S1, S2>;
 
 /// Difference between two dates in MJdays and T.
 /// Diff is dt1 - dt2
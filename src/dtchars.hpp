@@ -0,0 +1,273 @@
+///
+/// @file  dtchars.hpp
+///
+/// @brief Low-level, character-level helpers used by the datetime parsers and
+///        formatters.
+///
+/// The functions in this file operate on raw character ranges (aka
+/// [first, last) pointers); they never allocate and never throw. They are
+/// meant to be the building blocks of the (fast) datetime readers/writers,
+/// not to be used directly by users.
+///
+/// @author xanthos
+///
+/// @bug No known bugs.
+///
+
+#ifndef __DTCHARS_NGPT__HPP__
+#define __DTCHARS_NGPT__HPP__
+
+#include <cstring>
+#include <type_traits>
+#include "dtfund.hpp"
+
+namespace ngpt
+{
+
+namespace dtchars
+{
+
+/// @brief Number of decimal digits of the fractional part of a second type.
+///
+/// E.g. 0 for ngpt::seconds, 3 for ngpt::milliseconds, 6 for
+/// ngpt::microseconds.
+///
+/// @tparam S Any class of second type, i.e. any class S that has a (static)
+///           member variable S::is_of_sec_type set to true.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  constexpr int
+  sec_digits() noexcept
+{
+  int digits = 0;
+  for (long f = S::template sec_factor<long>(); f > 1L; f /= 10L) ++digits;
+  return digits;
+}
+
+/// @brief Integral power of 10, i.e. 10^n for n >= 0.
+constexpr long
+pow10(int n) noexcept
+{
+  long p = 1L;
+  while (n-- > 0) p *= 10L;
+  return p;
+}
+
+/// Is the character a decimal digit ? (locale-independent)
+constexpr bool
+is_digit(char c) noexcept
+{ return static_cast<unsigned char>(c - '0') < 10; }
+
+/// Is the character a (ASCII) letter ? (locale-independent)
+constexpr bool
+is_alpha(char c) noexcept
+{ return static_cast<unsigned char>((c | 0x20) - 'a') < 26; }
+
+/// Is the character a blank, i.e. space or tab ?
+constexpr bool
+is_blank(char c) noexcept
+{ return c == ' ' || c == '\t'; }
+
+/// @brief Resolve an unsigned integer of at most maxw digits.
+///
+/// @param[in]  first Start of the character range
+/// @param[in]  last  End of the character range (one past the last char)
+/// @param[in]  maxw  Maximum number of digits to consume
+/// @param[out] val   The resolved integer
+/// @return           Pointer to the first character not interpreted, or
+///                   nullptr if not even one digit could be resolved.
+inline const char*
+parse_uint(const char* first, const char* last, int maxw, long& val) noexcept
+{
+  const char* p = first;
+  long v = 0L;
+  while (p < last && maxw-- > 0 && is_digit(*p)) v = v * 10L + (*p++ - '0');
+  if (p == first) return nullptr;
+  val = v;
+  return p;
+}
+
+/// @brief Resolve the digits of a fractional part to an integer of exactly
+///        n digits.
+///
+/// All consecutive digits are consumed; only the first n are taken into
+/// account (the rest are truncated). If less than n digits are available, the
+/// result is scaled so that it always represents n digits, e.g. for n=6 the
+/// input "12" is resolved to 120000.
+///
+/// @param[in]  first Start of the character range
+/// @param[in]  last  End of the character range (one past the last char)
+/// @param[in]  n     Number of digits of the result
+/// @param[out] val   The resolved integer
+/// @return           Pointer to the first character not interpreted, or
+///                   nullptr if not even one digit could be resolved.
+inline const char*
+parse_fraction(const char* first, const char* last, int n, long& val) noexcept
+{
+  const char* p = first;
+  long v = 0L;
+  int  d = 0;
+  for (; p < last && is_digit(*p); ++p) {
+    if (d < n) {
+      v = v * 10L + (*p - '0');
+      ++d;
+    }
+  }
+  if (p == first) return nullptr;
+  val = v * pow10(n - d);
+  return p;
+}
+
+/// @brief Number of decimal digits needed to write a non-negative integer.
+constexpr int
+count_digits(unsigned long v) noexcept
+{
+  int d = 1;
+  while (v >= 10UL) {
+    v /= 10UL;
+    ++d;
+  }
+  return d;
+}
+
+/// @brief All two-digit decimal strings, i.e. "00", "01", ... "99".
+///
+/// Integers are written two digits at a time, by copying (a pair of chars)
+/// from this table; this halves the number of divisions needed.
+constexpr char digit_pairs[201] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+/// @brief Write an integer in the range [0,99] as exactly 2 digits.
+/// @return Pointer to one past the last character written.
+inline char*
+write_2digits(char* p, unsigned long v) noexcept
+{
+  std::memcpy(p, digit_pairs + 2 * v, 2);
+  return p + 2;
+}
+
+/// @brief Magnitude of a (possibly negative) integer.
+constexpr unsigned long
+magnitude(long v) noexcept
+{ return v < 0L ? 0UL - static_cast<unsigned long>(v) : v; }
+
+/// @brief Number of chars needed to write a year, i.e. at least 4 digits,
+///        plus a '-' for negative years.
+constexpr int
+year_width(long y) noexcept
+{
+  const int d = count_digits(magnitude(y));
+  return (y < 0L) + (d > 4 ? d : 4);
+}
+
+/// @brief Maximum number of chars needed to write any year (see
+///        ngpt::dtchars::year_width).
+constexpr int max_year_width = 20;
+
+/// @brief Write a non-negative integer, zero-padded to exactly w digits.
+///
+/// The caller must make sure that there is room for w characters and that
+/// the value fits in w digits; (higher order) digits that do not fit are
+/// silently lost.
+///
+/// @return Pointer to one past the last character written.
+inline char*
+write_uint(char* p, unsigned long v, int w) noexcept
+{
+  char* end = p + w;
+  char* q = end;
+  while (q - p >= 2) {
+    q -= 2;
+    std::memcpy(q, digit_pairs + 2 * (v % 100UL), 2);
+    v /= 100UL;
+  }
+  if (q > p) *--q = static_cast<char>('0' + v % 10UL);
+  return end;
+}
+
+/// @brief Write a year, as a '-' (if negative) followed by the magnitude,
+///        zero-padded to fill exactly w (see ngpt::dtchars::year_width)
+///        characters.
+/// @return Pointer to one past the last character written.
+inline char*
+write_year(char* p, long y, int w) noexcept
+{
+  if (y < 0L) {
+    *p++ = '-';
+    --w;
+  }
+  return write_uint(p, magnitude(y), w);
+}
+
+/// @brief Write the fractional part of a second, with exactly n digits.
+///
+/// @param[in] p       Where to write
+/// @param[in] frac    The fractional part of the second, in ticks with
+///                    sdigits decimal digits (see ngpt::dtchars::sec_digits)
+/// @param[in] sdigits Number of decimal digits of frac
+/// @param[in] n       Number of digits to write; if less than sdigits, the
+///                    fraction is truncated, else it is padded with zeros.
+/// @return Pointer to one past the last character written.
+inline char*
+write_fraction(char* p, unsigned long frac, int sdigits, int n) noexcept
+{
+  const unsigned long f = (n <= sdigits)
+    ? frac / pow10(sdigits - n)
+    : frac * pow10(n - sdigits);
+  return write_uint(p, f, n);
+}
+
+/// @brief Number of chars needed to write a time of day with the given
+///        number of fractional digits (see ngpt::dtchars::write_time).
+constexpr int
+time_width(int digits) noexcept
+{ return 8 + (digits > 0 ? digits + 1 : 0); }
+
+/// @brief Write a time of day, as HH:MM:SS[.f...].
+///
+/// @tparam S Any class of second type.
+/// @param[in] p      Where to write; there must be room for at least
+///                   8 (+1+digits if digits > 0) characters.
+/// @param[in] ticks  The time of day, in S (e.g. datetime::sec_as_i)
+/// @param[in] digits Number of fractional digits; if 0, no fractional part
+///                   (and no decimal point) is written.
+/// @return Pointer to one past the last character written.
+template<typename S,
+        typename = std::enable_if_t<S::is_of_sec_type>
+        >
+  char*
+  write_time(char* p, long ticks, int digits) noexcept
+{
+  constexpr long factor = S::template sec_factor<long>();
+  const long tsec = ticks / factor;
+  p = write_2digits(p, tsec / 3600L);
+  *p++ = ':';
+  p = write_2digits(p, (tsec % 3600L) / 60L);
+  *p++ = ':';
+  p = write_2digits(p, tsec % 60L);
+  if (digits > 0) {
+    *p++ = '.';
+    p = write_fraction(p, ticks % factor, sec_digits<S>(), digits);
+  }
+  return p;
+}
+
+/// @brief Case-insensitive compare of n (ASCII) letters.
+inline bool
+alpha_iequal(const char* str1, const char* str2, std::size_t n) noexcept
+{
+  for (std::size_t i = 0; i < n; i++)
+    if ((str1[i] | 0x20) != (str2[i] | 0x20)) return false;
+  return true;
+}
+
+} // namespace dtchars
+
+} // namespace ngpt
+
+#endif
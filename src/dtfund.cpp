@@ -82,52 +82,51 @@ ngpt::cal2mjd(ngpt::year y, ngpt::month m, ngpt::day_of_month d)
   return ngpt::modified_julian_day{mjd};
 }
 
-int
-__lower_strncmp__(const char *str1, const char *str2, std::size_t n=0)
+/// Map the first three (lowercased) chars of a month name to a slot in
+/// [0,16); the mapping is collision-free for the 12 month names.
+constexpr int
+__month_hash__(unsigned c0, unsigned c1, unsigned c2) noexcept
+{ return ((6U*c0 + 23U*c1 + c2) >> 1) & 15U; }
+
+/// Month (in [1,12]) occupying each slot of __month_hash__; 0 for
+/// empty slots.
+constexpr static int month_slot[16] = {
+   1, 11,  0,  0,  4,  7,  6, 12,  8, 10,  9,  3,  2,  0,  0,  5
+};
+
+ngpt::month::underlying_type
+ngpt::month_from_str(const char* str, std::size_t len) noexcept
 {
-  if (!n) n = std::max(std::strlen(str1), std::strlen(str2));
-  for (std::size_t i = 0; i < n; i++) 
-    if ( !(std::tolower(str1[i]) == std::tolower(str2[i])) ) 
-      return 1;
-  return 0;
+  if (len < 3) return 0;
+  const unsigned c0 = static_cast<unsigned char>(str[0]) | 0x20U;
+  const unsigned c1 = static_cast<unsigned char>(str[1]) | 0x20U;
+  const unsigned c2 = static_cast<unsigned char>(str[2]) | 0x20U;
+  const int m = month_slot[__month_hash__(c0, c1, c2)];
+  if (!m) return 0;
+
+  const month mnt {m};
+  const char* name = (len == 3) ? mnt.short_name() : mnt.long_name();
+  for (std::size_t i = 0; i < len; i++) {
+    if (!name[i] || (static_cast<unsigned char>(str[i]) | 0x20U)
+      != (static_cast<unsigned char>(name[i]) | 0x20U)) return 0;
+  }
+  return (len == 3 || name[len] == '\0') ? m : 0;
 }
 
 ///
 /// Given a c-string (i.e. null-terminating char array), resolve the month.
 /// The c-string can be either a short name (i.e. a 3-character name), e.g.
 /// "Jan", or the whole, normal month name e.g. "January". 
-/// If a 3-char length string is passed in, we are going to compare using the
-/// month::short_names array; else if the length of the input string is more
-/// than 3-chars, the month::long_names array is used.
-/// The comparisson is performed with both strings (aka the input string and
-/// each of the long/short_names arrays) beeing already transformed to lowercase
-/// That means that this function is actually case-insensitive!
+/// The comparisson is case-insensitive; see ngpt::month_from_str.
 /// If the input string cannot be matced to any of the strings in short_names
 /// and long_names, then an exception is thrown of type: std::invalid_argument
 /// Note that the month will be returned in the "normal" range [1,12], 
 /// **not** [0-11].
 ///
 ngpt::month::month(const char* str)
+  : m_month{month_from_str(str, std::strlen(str))}
 {
-  m_month = 0;
-
-  if ( std::strlen(str) == 3 ) {
-    for (int i = 0; i < 12; ++i) {
-      if ( !__lower_strncmp__(short_names[i], str, 3) ) {
-        m_month = i+1;
-        break;
-      }
-    }
-  } else if ( std::strlen(str) > 3 ) {
-    for (int i = 0; i < 12; ++i) {
-      if ( !__lower_strncmp__(long_names[i], str) ) {
-        m_month = i+1;
-        break;
-      }
-    }
-  }
-
-  if (!m_month || std::strlen(str) < 3 ) {
+  if (!m_month) {
     throw std::invalid_argument("Failed to set month from string \""
       +std::string(str)+"\"");
   }
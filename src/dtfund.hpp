@@ -25,6 +25,7 @@
 #include <tuple>
 #include <cstring>
 #include <string>
+#include <string_view>
 
 #ifdef DEBUG
 # include <iostream>
@@ -370,6 +371,28 @@ private:
 
 }; // class month
 
+/// @brief Resolve a month from its (short or long) name; non-throwing.
+///
+/// A string of 3 chars is matched against the short month names (e.g. "Jan"),
+/// a longer one against the long names (e.g. "January"). The comparisson is
+/// case-insensitive. The string need not be null-terminated; exactly len chars
+/// are examined.
+/// The lookup is a perfect hash over the first three (lowercased) chars,
+/// followed by a verification of the whole name, i.e. there is no linear
+/// search over the month names.
+///
+/// @param[in] str The month's name
+/// @param[in] len The number of characters in str
+/// @return        The month in the range [1,12], or 0 if str is not a valid
+///                month name.
+month::underlying_type
+month_from_str(const char* str, std::size_t len) noexcept;
+
+/// @overload ngpt::month_from_str(const char*, std::size_t) noexcept
+inline month::underlying_type
+month_from_str(std::string_view str) noexcept
+{ return month_from_str(str.data(), str.size()); }
+
 /// @class gps_week
 /// @brief A wrapper class for GPS Week.
 ///
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_arrow.hpp"
+
+using namespace ngpt;
+
+int main()
+{
+  std::cout<<"Testing Arrow C Data Interface export\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  // conversion to Arrow ticks, in all units
+  std::vector<datetime<microseconds>> epochs;
+  epochs.push_back(strptime_ymd_hms<microseconds>("1970-01-01 00:00:00"));
+  epochs.push_back(strptime_ymd_hms<microseconds>("1970-01-01 00:00:01.500001"));
+  epochs.push_back(strptime_ymd_hms<microseconds>("1969-12-31 23:59:59.250000"));
+  epochs.push_back(strptime_ymd_hms<microseconds>("2015-12-30 02:09:59.999996"));
+  std::int64_t ticks[4];
+  to_arrow_ticks(epochs.data(), 4, ticks);
+  assert( ticks[0] == 0 && ticks[1] == 1500001 && ticks[2] == -750000 );
+  assert( ticks[3] == 1451441399999996LL );
+  to_arrow_ticks(epochs.data(), 4, ticks, arrow_time_unit::ns);
+  assert( ticks[1] == 1500001000 && ticks[3] == 1451441399999996000LL );
+  to_arrow_ticks(epochs.data(), 4, ticks, arrow_time_unit::ms);
+  assert( ticks[1] == 1500 && ticks[2] == -750 && ticks[3] == 1451441399999LL );
+  to_arrow_ticks(epochs.data(), 4, ticks, arrow_time_unit::s);
+  assert( ticks[1] == 1 && ticks[2] == -1 && ticks[3] == 1451441399LL );
+  static_assert( arrow_native_unit<seconds>() == arrow_time_unit::s, "" );
+  static_assert( arrow_native_unit<milliseconds>() == arrow_time_unit::ms, "");
+
+  // export (copying), with the time scale in the metadata
+  ArrowArray arr;
+  ArrowSchema sch;
+  export_arrow_timestamps(epochs.data(), epochs.size(), &arr, &sch,
+    time_scale::gps);
+  assert( arr.length == 4 && arr.null_count == 0 && arr.n_buffers == 2 );
+  assert( arr.buffers[0] == nullptr );
+  const std::int64_t* values = static_cast<const std::int64_t*>(arr.buffers[1]);
+  assert( values[1] == 1500001 && values[3] == 1451441399999996LL );
+  assert( !std::strcmp(sch.format, "tsu:") );
+  std::int32_t len;
+  std::memcpy(&len, sch.metadata, 4);
+  assert( len == 1 );
+  std::memcpy(&len, sch.metadata + 4, 4);
+  assert( std::string(sch.metadata + 8, len) == "ngpt.time_scale" );
+  const char* v = sch.metadata + 8 + len;
+  std::memcpy(&len, v, 4);
+  assert( std::string(v + 4, len) == "gps" );
+  arr.release(&arr);
+  sch.release(&sch);
+  assert( arr.release == nullptr && sch.release == nullptr );
+
+  // UTC epochs carry a timezone
+  export_arrow_timestamps(epochs.data(), epochs.size(), &arr, &sch,
+    time_scale::utc, arrow_time_unit::ns);
+  assert( !std::strcmp(sch.format, "tsn:UTC") );
+  arr.release(&arr);
+  sch.release(&sch);
+
+  // zero-copy export of ticks already in Arrow form
+  std::int64_t raw[3] = {1, 2, 3};
+  export_arrow_ticks(raw, 3, arrow_time_unit::ms, &arr, &sch);
+  assert( arr.buffers[1] == raw && !std::strcmp(sch.format, "tsm:") );
+  arr.release(&arr);
+  sch.release(&sch);
+  assert( raw[2] == 3 );
+
+  std::cout<<"All checks for Arrow C Data Interface export OK\n";
+  return 0;
+}
@@ -0,0 +1,169 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_batch.hpp"
+
+using namespace ngpt;
+
+typedef datetime<milliseconds> dt;
+
+static dt
+ep(const char* str)
+{ return strptime_ymd_hms<milliseconds>(str); }
+
+int main()
+{
+  std::cout<<"Testing batch kernels\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  std::vector<dt> in {ep("2015-12-30 00:00:14.999"), ep("2015-12-30 00:00:15"),
+                      ep("2015-12-30 00:00:30"), ep("2015-12-31 23:59:50"),
+                      ep("2015-12-30 00:00:00.001")};
+
+  // snapping to a 30 s grid
+  std::vector<dt> out(in.size());
+  snap_to_grid(in.data(), in.size(), milliseconds{30000L}, snap_mode::nearest,
+    out.data());
+  assert( out[0] == ep("2015-12-30 00:00:00") );
+  assert( out[1] == ep("2015-12-30 00:00:30") );
+  assert( out[2] == ep("2015-12-30 00:00:30") );
+  assert( out[3] == ep("2016-01-01 00:00:00") );
+  assert( out[4] == ep("2015-12-30 00:00:00") );
+  snap_to_grid(in.data(), in.size(), milliseconds{30000L}, snap_mode::floor,
+    out.data());
+  assert( out[1] == ep("2015-12-30 00:00:00") && out[2] == in[2] );
+  assert( out[3] == ep("2015-12-31 23:59:30") );
+  snap_to_grid(in.data(), in.size(), milliseconds{30000L}, snap_mode::ceil,
+    out.data());
+  assert( out[0] == ep("2015-12-30 00:00:30") && out[2] == in[2] );
+  assert( out[3] == ep("2016-01-01 00:00:00") );
+  assert( out[4] == ep("2015-12-30 00:00:30") );
+
+  // a grid that does not divide the day runs continuously from MJD 0
+  dt t0 {modified_julian_day{1}, milliseconds{0L}};  // 86400 s = 12342*7 + 6
+  snap_to_grid(&t0, 1, milliseconds{7000L}, snap_mode::floor, out.data());
+  assert( out[0] == (dt{modified_julian_day{0}, milliseconds{86394000L}}) );
+  snap_to_grid(&t0, 1, milliseconds{7000L}, snap_mode::nearest, out.data());
+  assert( out[0] == (dt{modified_julian_day{1}, milliseconds{1000L}}) );
+
+  // in-place snapping
+  std::vector<dt> v = in;
+  snap_to_grid(v.data(), v.size(), milliseconds{1000L}, snap_mode::nearest,
+    v.data());
+  assert( v[0] == ep("2015-12-30 00:00:15") && v[4] == ep("2015-12-30 00:00:00") );
+
+  // decimation
+  std::vector<std::size_t> idx(in.size());
+  std::size_t k = decimate(in.data(), in.size(), milliseconds{30000L},
+    milliseconds{1L}, idx.data());
+  assert( k == 2 && idx[0] == 2 && idx[1] == 4 );
+  k = decimate(in.data(), in.size(), milliseconds{30000L}, milliseconds{0L},
+    idx.data());
+  assert( k == 1 && idx[0] == 2 );
+  k = decimate(in.data(), in.size(), milliseconds{5000L}, milliseconds{0L},
+    idx.data());
+  assert( k == 3 && idx[0] == 1 && idx[1] == 2 && idx[2] == 3 );
+
+  // the reciprocal remainder used when the grid divides the day
+  for (long d : {1L, 30L, 300L, 30000L, 86400000000L}) {
+    const dtchars::grid_divisor g {d};
+    for (long x : {0L, d - 1L, d, 86399999999L, 4611686018427387904L})
+      assert( g.remainder(x) == x % d );
+  }
+
+  bool thrown = false;
+  try {
+    decimate(in.data(), in.size(), milliseconds{0L}, milliseconds{0L},
+      idx.data());
+  } catch (std::invalid_argument&) {
+    thrown = true;
+  }
+  assert( thrown );
+
+  // calendar bucketing, against the per-epoch conversions
+  std::vector<dt> cal;
+  for (long d = 30000L; d < 70000L; d += 13L)
+    cal.push_back(dt{modified_julian_day{d}, milliseconds{(d * 7919L)
+      % milliseconds::max_in_day}});
+  std::vector<long> hkey(cal.size()), dkey(cal.size()), wkey(cal.size()),
+    ykey(cal.size()), mkey(cal.size());
+  bucketize(cal.data(), cal.size(), bucket_unit::hour, hkey.data());
+  bucketize(cal.data(), cal.size(), bucket_unit::day, dkey.data());
+  bucketize(cal.data(), cal.size(), bucket_unit::gps_week, wkey.data());
+  bucketize(cal.data(), cal.size(), bucket_unit::day_of_year, ykey.data());
+  bucketize(cal.data(), cal.size(), bucket_unit::month, mkey.data());
+  for (std::size_t i = 0; i < cal.size(); i++) {
+    const long mjd = cal[i].mjd().as_underlying_type();
+    assert( hkey[i] == mjd * 24L + cal[i].sec_as_i() / 3600000L );
+    assert( dkey[i] == mjd );
+    if (mjd >= jan61980) {
+      long sow;
+      assert( wkey[i] == cal[i].as_gps_wsow(sow).as_underlying_type() );
+    }
+    auto ydoy = cal[i].as_ydoy();
+    assert( ykey[i] == ydoy.__doy.as_underlying_type() );
+    auto ymd = cal[i].as_ymd();
+    assert( mkey[i] == ymd.__year.as_underlying_type() * 12L
+                     + ymd.__month.as_underlying_type() - 1L );
+  }
+  // differences from a reference epoch (mixed precision)
+  auto ref_s = strptime_ymd_hms<seconds>("2015-12-30 12:09:30");
+  std::vector<long> dms(cal.size());
+  std::vector<double> dfs(cal.size());
+  delta_sec(cal.data(), cal.size(), ref_s, dms.data());
+  delta_sec(cal.data(), cal.size(), ref_s, dfs.data());
+  for (std::size_t i = 0; i < cal.size(); i++) {
+    const milliseconds d = ngpt::delta_sec(cal[i], ref_s);
+    assert( dms[i] == d.as_underlying_type() );
+    assert( dfs[i] == d.to_fractional_seconds() );
+  }
+  std::vector<datetime<seconds>> cal_s;
+  for (const auto& t : cal)
+    cal_s.push_back(datetime<seconds>{t.mjd(), seconds{t.sec_as_i() / 1000L}});
+  const dt ref_ms = ep("2015-12-30 12:09:30.123");
+  delta_sec(cal_s.data(), cal_s.size(), ref_ms, dms.data());
+  for (std::size_t i = 0; i < cal_s.size(); i++)
+    assert( dms[i] == ngpt::delta_sec(cal_s[i], ref_ms).as_underlying_type() );
+  std::vector<datetime_interval<milliseconds>> dd(cal.size());
+  const dt ref_d = cal[cal.size() / 2];
+  delta_date(cal.data(), cal.size(), ref_d, dd.data());
+  std::vector<long> vdays(cal.size()), vsecs(cal.size());
+  delta_date(datetime_vector<milliseconds>{cal.data(), cal.size()}, ref_d,
+    vdays.data(), vsecs.data());
+  for (std::size_t i = 0; i < cal.size(); i++) {
+    assert( dd[i] == cal[i].delta_date(ref_d) );
+    assert( dd[i].to_sec() == ngpt::delta_sec(cal[i], ref_d) );
+    assert( (dd[i].sign() < 0) == (i < cal.size() / 2) );
+    assert( vdays[i] == dd[i].days().as_underlying_type()
+         && vsecs[i] == dd[i].sec().as_underlying_type() );
+  }
+  std::vector<double> dvs(cal.size());
+  delta_sec(datetime_vector<milliseconds>{cal.data(), cal.size()}, ref_s,
+    dvs.data());
+  assert( dvs == dfs );
+
+  datetime_vector<milliseconds> calv {cal.data(), cal.size()};
+  std::vector<long> vkey(cal.size());
+  bucketize(calv, bucket_unit::month, vkey.data());
+  assert( vkey == mkey );
+
+  // histogram of the bucket keys
+  std::vector<std::size_t> counts(12, 0);
+  std::size_t outside = histogram(ykey.data(), ykey.size(), 1L, 12,
+    counts.data());
+  std::size_t ref_outside = 0;
+  std::vector<std::size_t> ref(12, 0);
+  for (long key : ykey)
+    (key >= 1L && key <= 12L) ? ++ref[key - 1] : ++ref_outside;
+  assert( counts == ref && outside == ref_outside );
+  // counts are accumulated
+  histogram(ykey.data(), ykey.size(), 1L, 12, counts.data());
+  assert( counts[0] == 2 * ref[0] && counts[11] == 2 * ref[11] );
+
+  std::cout<<"All checks for batch kernels OK\n";
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_binary.hpp"
+
+using namespace ngpt;
+
+int main()
+{
+  std::cout<<"Testing binary epoch encoding\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  // linear ticks round trip, including epochs before MJD 0
+  auto t1 = strptime_ymd_hms<microseconds>("2015-12-30 02:09:59.999996");
+  assert( from_linear_ticks<microseconds>(to_linear_ticks(t1)) == t1 );
+  datetime<milliseconds> t0 {modified_julian_day{-2}, milliseconds{1234L}};
+  assert( to_linear_ticks(t0) < 0 );
+  assert( from_linear_ticks<milliseconds>(to_linear_ticks(t0)) == t0 );
+
+  // records are little endian
+  unsigned char rec[8];
+  datetime<seconds> t2 {modified_julian_day{0}, seconds{258L}};
+  encode_epochs(&t2, 1, rec);
+  assert( rec[0] == 2 && rec[1] == 1 && rec[7] == 0 );
+
+  // write a file and view it
+  std::vector<datetime<microseconds>> epochs;
+  for (int i = 0; i < 1000; i++) {
+    epochs.push_back(t1);
+    t1.add_seconds(microseconds{250000L});
+  }
+  char path[] = "/tmp/ngdtXXXXXX";
+  const int fd = ::mkstemp(path);
+  assert( fd >= 0 );
+  ::close(fd);
+  write_epoch_file(path, epochs.data(), epochs.size(), time_scale::gps);
+  {
+    epoch_file_view<microseconds> view {path};
+    assert( view.size() == epochs.size() );
+    assert( view.header().scale == to_time_scale(GnssTimeSystem::gps) );
+    assert( view.header().precision == 6 );
+    for (std::size_t i = 0; i < view.size(); i++) {
+      assert( view[i] == epochs[i] );
+      if (view.tick_data())
+        assert( view.tick_data()[i] == to_linear_ticks(epochs[i]) );
+    }
+    std::vector<datetime<microseconds>> decoded(view.size());
+    decode_epochs(view.records(), view.size(), decoded.data());
+    assert( decoded == epochs );
+  }
+
+  // precision mismatch and invalid files throw
+  bool thrown = false;
+  try {
+    epoch_file_view<milliseconds> view {path};
+  } catch (std::runtime_error&) {
+    thrown = true;
+  }
+  assert( thrown );
+  std::FILE* fp = std::fopen(path, "w");
+  std::fputs("not an epoch file, though long enough", fp);
+  std::fclose(fp);
+  thrown = false;
+  try {
+    epoch_file_view<microseconds> view {path};
+  } catch (std::runtime_error&) {
+    thrown = true;
+  }
+  assert( thrown );
+  std::remove(path);
+
+  std::cout<<"All checks for binary epoch encoding OK\n";
+  return 0;
+}
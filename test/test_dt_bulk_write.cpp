@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_write.hpp"
+#include "datetime_bulk_write.hpp"
+
+using namespace ngpt;
+
+// read back everything written to a (temporary) file
+std::string
+contents(std::FILE* fp)
+{
+  std::string str;
+  char buf[256];
+  std::rewind(fp);
+  for (std::size_t n; (n = std::fread(buf, 1, sizeof buf, fp)) > 0; )
+    str.append(buf, n);
+  return str;
+}
+
+int main()
+{
+  std::cout<<"Testing bulk epoch writer\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  // 10 Hz epochs, crossing a day boundary
+  std::vector<datetime<milliseconds>> epochs;
+  auto t = strptime_ymd_hms<milliseconds>("2015-12-31 23:59:58.000");
+  for (int i = 0; i < 50; i++) {
+    epochs.push_back(t);
+    t.add_seconds(milliseconds{100});
+  }
+
+  // reference output via the to_chars formatters
+  std::string ref;
+  char buf[64];
+  for (const auto& e : epochs) {
+    auto res = to_chars_ymd_hms(buf, buf + sizeof buf, e, '-', 3);
+    ref.append(buf, res.ptr);
+    ref += '\n';
+  }
+
+  // a small buffer forces several flushes
+  std::FILE* fp = std::tmpfile();
+  assert( fp );
+  {
+    epoch_writer<milliseconds> w {fileno(fp), epoch_layout::ymd, '-', 3, 64};
+    w.write(epochs.data(), epochs.data() + epochs.size());
+  } // flushed on destruction
+  assert( contents(fp) == ref );
+  std::fclose(fp);
+
+  // negative and wide years fit the cached date prefix
+  fp = std::tmpfile();
+  assert( fp );
+  {
+    const datetime<milliseconds> odd[] = {
+      datetime<milliseconds>{modified_julian_day{-700000L}, milliseconds{0L}},
+      datetime<milliseconds>{modified_julian_day{4000000L}, milliseconds{0L}}};
+    epoch_writer<milliseconds> w {fileno(fp), epoch_layout::yod, '-', 3};
+    w.write(odd, odd + 2);
+  }
+  assert( contents(fp) == "-0058-May-06 00:00:00.000\n"
+                          "12810-Jul-04 00:00:00.000\n" );
+  std::fclose(fp);
+
+  // other layouts, single epochs and data columns
+  fp = std::tmpfile();
+  assert( fp );
+  epoch_writer<milliseconds> w {fileno(fp), epoch_layout::yod, ' ', 1};
+  w.put(epochs[0]);
+  w.put(" G01", 4);
+  w.put('\n');
+  w.flush();
+  assert( contents(fp) == "2015 Dec 31 23:59:58.0 G01\n" );
+  std::fclose(fp);
+
+  fp = std::tmpfile();
+  assert( fp );
+  {
+    epoch_writer<milliseconds> w1 {fileno(fp), epoch_layout::ydoy, '-', 0};
+    w1.write(&epochs[49], &epochs[49] + 1);
+  }
+  {
+    epoch_writer<milliseconds> w2 {fileno(fp), epoch_layout::iso, '-', 3};
+    w2.write(&epochs[49], &epochs[49] + 1);
+  }
+  assert( contents(fp) == "2016-001 00:00:02\n2016-01-01T00:00:02.900\n" );
+  std::fclose(fp);
+
+  // invalid number of digits throws
+  bool thrown = false;
+  try {
+    epoch_writer<seconds> w3 {1, epoch_layout::ymd, '-', 10};
+  } catch (std::invalid_argument&) {
+    thrown = true;
+  }
+  assert( thrown );
+
+  std::cout<<"All checks for epoch_writer OK\n";
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_codec.hpp"
+
+using namespace ngpt;
+
+int main()
+{
+  std::cout<<"Testing delta-of-delta epoch compression\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  // a regular 30 s stream costs about one bit per epoch
+  auto t = strptime_ymd_hms<microseconds>("2015-12-30 00:00:00");
+  std::vector<datetime<microseconds>> regular;
+  compressed_epochs<microseconds> c1;
+  for (int i = 0; i < 100000; i++) {
+    regular.push_back(t);
+    c1.push_back(t);
+    t.add_seconds(microseconds{30000000L});
+  }
+  assert( c1.size() == regular.size() );
+  assert( c1.index().size() == 25 );
+  assert( c1.bytes() * 8 < regular.size() * 11 / 10 );
+  std::vector<datetime<microseconds>> out(regular.size());
+  assert( c1.decode(0, out.size(), out.data()) == out.size() );
+  assert( out == regular );
+
+  // random access, partial decoding and searching
+  assert( c1[0] == regular[0] );
+  assert( c1[4095] == regular[4095] && c1[4096] == regular[4096] );
+  assert( c1[54321] == regular[54321] );
+  assert( c1[99999] == regular[99999] );
+  assert( c1.decode(99990, 100, out.data()) == 10 );
+  assert( out[9] == regular[99999] );
+  assert( c1.decode(4094, 5, out.data()) == 5 );
+  assert( out[0] == regular[4094] && out[4] == regular[4098] );
+  assert( c1.lower_bound(regular[0]) == 0 );
+  assert( c1.lower_bound(regular[4567]) == 4567 );
+  datetime<microseconds> tx = regular[4567];
+  tx.add_seconds(microseconds{1L});
+  assert( c1.lower_bound(tx) == 4568 );
+  assert( c1.lower_bound(t) == c1.size() );
+
+  // irregular streams (jitter, gaps, steps backwards and epochs before
+  // MJD 0) are encoded exactly
+  std::vector<datetime<milliseconds>> irregular;
+  compressed_epochs<milliseconds> c2 {64};
+  datetime<milliseconds> s {modified_julian_day{-3}, milliseconds{0L}};
+  std::uint32_t seed = 12345u;
+  for (int i = 0; i < 5000; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    long step = 1000L;
+    switch ((seed >> 24) % 6) {
+      case 0: step += (seed >> 8) % 100; break;
+      case 1: step += (seed >> 8) % 5000; break;
+      case 2: step += (seed >> 8) % 1000000; break;
+      case 3: step = -static_cast<long>((seed >> 8) % 86400000L); break;
+      case 4: step *= 86400L * 400L; break;
+      default: break;
+    }
+    s.add_seconds(milliseconds{step});
+    irregular.push_back(s);
+    c2.push_back(s);
+  }
+  std::vector<datetime<milliseconds>> out2(irregular.size());
+  assert( c2.decode(0, out2.size(), out2.data()) == out2.size() );
+  assert( out2 == irregular );
+  for (std::size_t i = 0; i < irregular.size(); i += 37)
+    assert( c2[i] == irregular[i] );
+
+  // equal epochs straddling a block boundary; lower_bound finds the first
+  compressed_epochs<seconds> c4 {4};
+  const datetime<seconds> e0 {modified_julian_day{58000L}, seconds{0L}};
+  const datetime<seconds> e1 {modified_julian_day{58000L}, seconds{30L}};
+  const datetime<seconds> e2 {modified_julian_day{58000L}, seconds{60L}};
+  for (int i = 0; i < 2; i++) c4.push_back(e0);
+  for (int i = 0; i < 5; i++) c4.push_back(e1); // positions 2 to 6
+  c4.push_back(e2);
+  assert( c4.lower_bound(e0) == 0 );
+  assert( c4.lower_bound(e1) == 2 );
+  assert( c4.lower_bound(e2) == 7 );
+
+  // empty sequences
+  compressed_epochs<seconds> c3;
+  datetime<seconds> d;
+  assert( !c3.size() && !c3.bytes() && !c3.decode(0, 1, &d) );
+
+  std::cout<<"All checks for delta-of-delta epoch compression OK\n";
+  return 0;
+}
@@ -0,0 +1,63 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_fmt.hpp"
+
+using namespace ngpt;
+
+int main()
+{
+  std::cout<<"Testing formatter specializations\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  const auto t1 = strptime_ymd_hms<microseconds>("2015-12-30 02:09:03.000011");
+  const auto t2 = strptime_ymd_hms<seconds>("2015-12-30 02:09:03");
+
+  // the core, iterator-based formatting
+  std::string str;
+  format_to(std::back_inserter(str), datetime_format<>{"%Y-%j %H:%M:%S.%3f"}, t1);
+  assert( str == "2015-364 02:09:03.000" );
+  str.clear();
+  datetime_interval<milliseconds> dt {modified_julian_day{2}, milliseconds{3723004L}};
+  format_to(std::back_inserter(str), dt);
+  assert( str == "2d 01:02:03.004" );
+  // every %Y of a wide (or negative) year is written in full
+  str.clear();
+  const datetime<seconds> t3 {modified_julian_day{4000000L}, seconds{0L}};
+  format_to(std::back_inserter(str), datetime_format<>{"%Y%Y%Y"}, t3);
+  assert( str == "128101281012810" );
+  str.clear();
+  const datetime<seconds> t4 {modified_julian_day{-700000L}, seconds{0L}};
+  format_to(std::back_inserter(str), datetime_format<>{"%Y-%m-%d"}, t4);
+  assert( str == "-0058-05-06" );
+
+#ifdef NGPT_HAS_FMT
+  assert( fmt::format("{}", t1) == "2015-12-30 02:09:03.000011" );
+  assert( fmt::format("{}", t2) == "2015-12-30 02:09:03" );
+  assert( fmt::format("{:%Y-%j %H:%M:%S.%6f}", t1) == "2015-364 02:09:03.000011" );
+  assert( fmt::format("[{:%d %b %Y}]", t2) == "[30 Dec 2015]" );
+  assert( fmt::format("{}", dt) == "2d 01:02:03.004" );
+  assert( fmt::format("{}", t1.as_ymd()) == "2015-12-30" );
+  assert( fmt::format("{:%Y/%m/%d}", t1.as_ymd()) == "2015/12/30" );
+  assert( fmt::format("{}", t1.as_ydoy()) == "2015-364" );
+  assert( fmt::format("{:>7}|{}", t1.mjd(), milliseconds{42}) == "  57386|42" );
+  bool thrown = false;
+  try {
+    (void)fmt::format(fmt::runtime("{:%Y-%q}"), t1);
+  } catch (fmt::format_error&) {
+    thrown = true;
+  }
+  assert( thrown );
+#else
+  std::cout<<"{fmt} not available; formatter specializations not tested\n";
+#endif
+
+  std::cout<<"All checks for formatter specializations OK\n";
+  return 0;
+}
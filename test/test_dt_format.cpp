@@ -0,0 +1,111 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_format.hpp"
+
+using namespace ngpt;
+
+// formats compiled at compile-time
+constexpr datetime_format<> ymd_hms  {"%Y-%m-%d %H:%M:%S"};
+constexpr datetime_format<> ymd_hmfs {"%Y-%m-%d %H:%M:%S.%f"};
+constexpr datetime_format<> ydoy_hms {"%Y-%j %H:%M:%S.%3f"};
+constexpr datetime_format<> yod_hms  {"%Y %b %d %H %M %S.%f"};
+static_assert( ymd_hms.size() == 11, "-- Compiled format has wrong size --" );
+static_assert( ymd_hmfs.has_date() && ydoy_hms.has_date(), "-- No date --" );
+
+template<typename S>
+  std::from_chars_result
+  parse(const datetime_format<>& fmt, const char* str, datetime<S>& t)
+{ return fmt.parse(str, str + std::strlen(str), t); }
+
+int main()
+{
+  std::cout<<"Testing compiled datetime formats\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  datetime<seconds> d1, d2;
+  // parse & compare against the (old) strptime_ymd_hms function
+  const char* date1_str = "2015-12-30 12:09:30";
+  assert( parse(ymd_hms, date1_str, d1).ec == std::errc{} );
+  assert( d1 == strptime_ymd_hms<seconds>(date1_str) );
+  // fields can have less digits than their nominal width
+  assert( parse(ymd_hms, "2015-12-30 12:9:30", d2).ec == std::errc{} );
+  assert( d1 == d2 );
+
+  // fractional seconds are resolved exactly
+  datetime<microseconds> d3, d4;
+  const char* date3_str = "2015-12-30 12:09:30.000011";
+  auto res = parse(ymd_hmfs, date3_str, d3);
+  assert( res.ec == std::errc{} && res.ptr == date3_str + std::strlen(date3_str));
+  assert( d3 == strptime_ymd_hms<microseconds>(date3_str) );
+  // extra digits are truncated
+  assert( parse(ymd_hmfs, "2015-12-30 12:09:30.0000119", d4).ec == std::errc{} );
+  assert( d3 == d4 );
+  // missing digits are zero
+  assert( parse(ymd_hmfs, "2015-12-30 12:09:30.5", d4).ec == std::errc{} );
+  assert( d4.sec_as_i() % 1000000L == 500000L );
+
+  // day of year and month names
+  datetime<milliseconds> d5, d6;
+  assert( parse(ydoy_hms, "2015-364 12:09:30.001", d5).ec == std::errc{} );
+  assert( parse(yod_hms, "2015 DEC 30 12 09 30.001", d6).ec == std::errc{} );
+  assert( d5 == d6 );
+  assert( parse(yod_hms, "2015 december 30 12 09 30.001", d6).ec == std::errc{} );
+  assert( d5 == d6 );
+
+  // errors are reported via error codes
+  assert( parse(ymd_hms, "2015/12/30 12:09:30", d1).ec == std::errc::invalid_argument );
+  assert( parse(ymd_hms, "2015-13-30 12:09:30", d1).ec == std::errc::result_out_of_range );
+  assert( parse(ymd_hms, "2015-02-29 12:09:30", d1).ec == std::errc::result_out_of_range );
+  assert( parse(ydoy_hms, "2015-366 12:09:30.0", d5).ec == std::errc::result_out_of_range );
+  assert( parse(yod_hms, "2015 Dex 30 12 09 30", d5).ec == std::errc::invalid_argument );
+  assert( d1 == d2 ); // not changed on failure
+
+  // formatting
+  char buf[64];
+  auto wres = ymd_hmfs.format(buf, buf + sizeof buf, d3);
+  assert( wres.ec == std::errc{} );
+  *wres.ptr = '\0';
+  assert( !std::strcmp(buf, date3_str) );
+  wres = ydoy_hms.format(buf, buf + sizeof buf, d3);
+  *wres.ptr = '\0';
+  assert( !std::strcmp(buf, "2015-364 12:09:30.000") );
+  wres = datetime_format<>{"%d %b %Y %H:%M:%S.%9f"}.format(buf, buf+sizeof buf, d5);
+  *wres.ptr = '\0';
+  assert( !std::strcmp(buf, "30 Dec 2015 12:09:30.001000000") );
+  // buffer too small
+  assert( ymd_hmfs.format(buf, buf + 10, d3).ec == std::errc::value_too_large );
+  // every year instruction needs room for the whole year (sign included)
+  constexpr datetime_format<> yyy {"%Y%Y%Y"};
+  const datetime<seconds> wide {modified_julian_day{4000000L}, seconds{0L}};
+  assert( yyy.max_chars<seconds>(5) == 15 );
+  assert( yyy.format(buf, buf + 14, wide).ec == std::errc::value_too_large );
+  wres = yyy.format(buf, buf + 15, wide);
+  assert( wres.ec == std::errc{} && wres.ptr == buf + 15 );
+  assert( !std::strncmp(buf, "128101281012810", 15) );
+  const datetime<seconds> neg {modified_julian_day{-700000L}, seconds{0L}};
+  wres = ymd_hms.format(buf, buf + sizeof buf, neg);
+  *wres.ptr = '\0';
+  assert( !std::strcmp(buf, "-0058-05-06 00:00:00") );
+
+  // round trip
+  datetime<microseconds> d7;
+  wres = ymd_hmfs.format(buf, buf + sizeof buf, d3);
+  assert( ymd_hmfs.parse(buf, wres.ptr, d7).ec == std::errc{} && d7 == d3 );
+
+  // invalid format strings throw (at runtime)
+  bool thrown = false;
+  try {
+    datetime_format<> f {"%Y-%q"};
+  } catch (std::invalid_argument&) {
+    thrown = true;
+  }
+  assert( thrown );
+
+  std::cout<<"All checks for datetime_format OK\n";
+  return 0;
+}
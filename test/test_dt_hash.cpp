@@ -0,0 +1,88 @@
+#include <iostream>
+#include <cassert>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_hash.hpp"
+
+using namespace ngpt;
+
+typedef datetime<milliseconds> dt;
+
+int main()
+{
+  std::cout<<"Testing epoch hashes and maps\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  auto t0 = strptime_ymd_hms<milliseconds>("2016-12-31 23:59:59.000");
+  auto at = [&](long ms) { dt t {t0}; t.add_seconds(milliseconds{ms});
+                           return t; };
+
+  // hashes agree on equal values and spread consecutive ones
+  std::hash<dt> hdt;
+  assert( hdt(at(1000)) == hdt(strptime_ymd_hms<milliseconds>(
+    "2017-01-01 00:00:00.000")) );
+  assert( hdt(at(0)) != hdt(at(1)) );
+  std::hash<modified_julian_day> hmjd;
+  assert( hmjd(modified_julian_day{57000L}) != hmjd(modified_julian_day{57001L}) );
+  assert( (hmjd(modified_julian_day{57000L}) >> 60)
+       != (hmjd(modified_julian_day{57001L}) >> 60)
+       || (hmjd(modified_julian_day{57001L}) >> 60)
+       != (hmjd(modified_julian_day{57002L}) >> 60) );
+  std::unordered_set<dt> eset;
+  std::unordered_map<seconds, int> smap;
+  std::unordered_set<modified_julian_day> dset;
+  for (long i = 0; i < 5000; i++) {
+    eset.insert(at(i * 30000L));
+    smap[seconds{i}] = static_cast<int>(i);
+    dset.insert(modified_julian_day{i / 2});
+  }
+  assert( eset.size() == 5000 && smap.size() == 5000 && dset.size() == 2500 );
+  assert( eset.count(at(30000L)) && !eset.count(at(30001L)) );
+  assert( std::hash<microseconds>{}(microseconds{5L})
+       == std::hash<microseconds>{}(microseconds{5L}) );
+
+  // the flat map against std::map, with random inserts and erasures
+  epoch_map<milliseconds, long> emap;
+  std::map<long, long> ref;
+  std::mt19937 gen(45);
+  std::uniform_int_distribution<long> key(-2000L, 200000L), op(0, 3);
+  for (int i = 0; i < 200000; i++) {
+    const long k = key(gen) * 1000L + (i % 7 == 0) * key(gen) % 1000L;
+    switch (op(gen)) {
+      case 0:
+      case 1: {
+        auto r = emap.insert(at(k), i);
+        auto s = ref.insert({k, i});
+        assert( r.second == s.second && *r.first == s.first->second );
+        break; }
+      case 2:
+        assert( emap.erase(at(k)) == (ref.erase(k) == 1) );
+        break;
+      default: {
+        const long* v = emap.find(at(k));
+        auto it = ref.find(k);
+        assert( (v == nullptr) == (it == ref.end()) );
+        if (v) assert( *v == it->second ); }
+    }
+    assert( emap.size() == ref.size() );
+  }
+  std::size_t n = 0;
+  emap.for_each([&](const dt& t, long v) {
+    auto it = ref.find(to_linear_ticks(t) - to_linear_ticks(t0));
+    assert( it != ref.end() && it->second == v );
+    ++n; });
+  assert( n == ref.size() );
+  emap[at(-5000000L)] = 7;
+  assert( emap.contains(at(-5000000L)) && *emap.find(at(-5000000L)) == 7 );
+  emap.clear();
+  assert( emap.empty() && !emap.contains(at(0)) );
+
+  std::cout<<"All checks for epoch hashes and maps OK\n";
+  return 0;
+}
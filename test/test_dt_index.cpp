@@ -0,0 +1,106 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_index.hpp"
+
+using namespace ngpt;
+
+typedef epoch_index<milliseconds> index_t;
+
+/// Reference results, via std::lower_bound/std::upper_bound.
+static void
+check(const std::vector<datetime<milliseconds>>& v, const index_t& idx,
+  const datetime<milliseconds>& q)
+{
+  const std::size_t lb = std::lower_bound(v.begin(), v.end(), q) - v.begin();
+  const std::size_t ub = std::upper_bound(v.begin(), v.end(), q) - v.begin();
+  assert( idx.ceil(q) == (lb < v.size() ? lb : index_t::npos) );
+  assert( idx.floor(q) == (ub ? ub - 1 : index_t::npos) );
+  const std::size_t n = idx.nearest(q);
+  if (v.empty()) {
+    assert( n == index_t::npos );
+    return;
+  }
+  const std::int64_t x = to_linear_ticks(q);
+  std::int64_t best = -1;
+  for (const auto& t : v) {
+    const std::int64_t d = std::abs(to_linear_ticks(t) - x);
+    if (best < 0 || d < best) best = d;
+  }
+  assert( std::abs(idx.ticks(n) - x) == best );
+  assert( !n || idx.ticks(n-1) == idx.ticks(n)
+          || std::abs(idx.ticks(n-1) - x) > best );
+}
+
+int main()
+{
+  std::cout<<"Testing epoch index\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  auto t0 = strptime_ymd_hms<milliseconds>("2015-12-30 00:00:00");
+
+  // indexes of all sizes up to (and past) a complete tree, with duplicates
+  for (std::size_t n : {0, 1, 2, 3, 7, 8, 100, 1023, 1024}) {
+    std::vector<datetime<milliseconds>> v;
+    auto t = t0;
+    for (std::size_t i = 0; i < n; i++) {
+      v.push_back(t);
+      if (i % 5) t.add_seconds(milliseconds{(long)(i % 7) * 15000L});
+    }
+    index_t idx {v.data(), v.size()};
+    assert( idx.size() == n );
+    auto q = t0;
+    q.add_seconds(milliseconds{-20000L});
+    std::vector<datetime<milliseconds>> qs;
+    for (std::size_t i = 0; i < 2 * n + 3; i++) {
+      check(v, idx, q);
+      qs.push_back(q);
+      q.add_seconds(milliseconds{7000L + (long)(i % 3) * 1000L});
+    }
+    // batched queries match the single ones
+    std::vector<std::size_t> out(qs.size());
+    idx.ceil(qs.data(), qs.size(), out.data());
+    for (std::size_t i = 0; i < qs.size(); i++)
+      assert( out[i] == idx.ceil(qs[i]) );
+    idx.floor(qs.data(), qs.size(), out.data());
+    for (std::size_t i = 0; i < qs.size(); i++)
+      assert( out[i] == idx.floor(qs[i]) );
+    idx.nearest(qs.data(), qs.size(), out.data());
+    for (std::size_t i = 0; i < qs.size(); i++)
+      assert( out[i] == idx.nearest(qs[i]) );
+  }
+
+  // within-tolerance queries
+  std::vector<datetime<milliseconds>> v;
+  for (int i = 0; i < 10; i++) {
+    v.push_back(t0);
+    t0.add_seconds(milliseconds{30000L});
+  }
+  index_t idx {v.data(), v.size()};
+  auto q = v[4];
+  q.add_seconds(milliseconds{500L});
+  assert( idx.within(q, milliseconds{500L}) == 4 );
+  assert( idx.within(q, milliseconds{499L}) == index_t::npos );
+  q.add_seconds(milliseconds{14500L}); // ties go to the earlier epoch
+  assert( idx.nearest(q) == 4 );
+  assert( idx[4] == v[4] );
+
+  // unsorted input is rejected
+  std::swap(v[2], v[3]);
+  bool thrown = false;
+  try {
+    index_t bad {v.data(), v.size()};
+  } catch (std::invalid_argument&) {
+    thrown = true;
+  }
+  assert( thrown );
+
+  std::cout<<"All checks for epoch index OK\n";
+  return 0;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_binary.hpp"
+#include "datetime_intervals.hpp"
+
+using namespace ngpt;
+
+typedef datetime<seconds> dt;
+typedef epoch_window<seconds> win_t;
+
+/// Brute-force membership of a tick in a list of windows.
+bool
+in_any(const std::vector<win_t>& w, std::int64_t t)
+{
+  for (const auto& x : w)
+    if (to_linear_ticks(x.start) <= t && t < to_linear_ticks(x.stop))
+      return true;
+  return false;
+}
+
+int main()
+{
+  std::cout<<"Testing interval sets and trees\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  auto t0 = strptime_ymd_hms<seconds>("2015-12-31 23:00:00");
+  auto at = [&](long s) { dt t {t0}; t.add_seconds(seconds{s}); return t; };
+
+  // construction merges overlapping and adjacent windows
+  std::vector<win_t> w {{at(100), at(200)}, {at(0), at(50)},
+                        {at(150), at(300)}, {at(50), at(60)},
+                        {at(400), at(400)}, {at(3600), at(7300)}};
+  interval_set<seconds> a {w.data(), w.size()};
+  assert( a.size() == 3 );
+  assert( a[0].start == at(0) && a[0].stop == at(60) );
+  assert( a[1].start == at(100) && a[1].stop == at(300) );
+  assert( a[2].start == at(3600) && a[2].stop == at(7300) );
+  assert( a.contains(at(0)) && a.contains(at(59)) && !a.contains(at(60)) );
+  assert( a.contains(at(3600)) && !a.contains(at(7300)) );
+  auto cov = a.coverage();
+  assert( cov.days().as_underlying_type() == 0
+       && cov.sec().as_underlying_type() == 60 + 200 + 3700 );
+
+  // insertion
+  interval_set<seconds> b;
+  b.insert(at(250), at(3700));
+  b.insert(at(7200), datetime_interval<seconds>{modified_julian_day{1L},
+                                                seconds{0L}});
+  assert( b.size() == 2 && b[1].stop == at(7200 + 86400) );
+  b.insert(at(3700), at(7200));
+  assert( b.size() == 1 );
+
+  // set operations
+  auto u = interval_union(a, b);
+  assert( u.size() == 2 && u[1].start == at(100) );
+  auto x = interval_intersection(a, b);
+  assert( x.size() == 2 && x[0].start == at(250) && x[0].stop == at(300) );
+  auto d = interval_difference(a, b);
+  assert( d.size() == 2 && d[1].start == at(100) && d[1].stop == at(250) );
+  assert( interval_difference(b, b).empty() );
+
+  // random windows against brute force
+  std::mt19937 gen(43);
+  std::uniform_int_distribution<long> pos(0L, 200000L), len(0L, 5000L);
+  std::vector<win_t> wa, wb;
+  for (int i = 0; i < 300; i++) {
+    long s = pos(gen); wa.push_back({at(s), at(s + len(gen))});
+    s = pos(gen);      wb.push_back({at(s), at(s + len(gen))});
+  }
+  interval_set<seconds> ra {wa.data(), wa.size()}, rb {wb.data(), wb.size()};
+  auto ru = interval_union(ra, rb);
+  auto ri = interval_intersection(ra, rb);
+  auto rd = interval_difference(ra, rb);
+  interval_tree<seconds> tree {wa.data(), wa.size()};
+  std::vector<std::size_t> hits;
+  for (long s = -10L; s < 206000L; s += 7L) {
+    const dt t = at(s);
+    const std::int64_t k = to_linear_ticks(t);
+    const bool ia = in_any(wa, k), ib = in_any(wb, k);
+    assert( ra.contains(t) == ia );
+    assert( ru.contains(t) == (ia || ib) );
+    assert( ri.contains(t) == (ia && ib) );
+    assert( rd.contains(t) == (ia && !ib) );
+    hits.clear();
+    tree.stab(t, std::back_inserter(hits));
+    std::vector<std::size_t> ref;
+    for (std::size_t i = 0; i < wa.size(); i++)
+      if (to_linear_ticks(wa[i].start) <= k && k < to_linear_ticks(wa[i].stop))
+        ref.push_back(i);
+    std::sort(hits.begin(), hits.end());
+    assert( hits == ref );
+  }
+
+  // overlap queries
+  hits.clear();
+  tree.overlap(at(1000), at(1001), std::back_inserter(hits));
+  std::size_t ref = 0;
+  for (const auto& v : wa)
+    ref += (to_linear_ticks(v.start) < to_linear_ticks(at(1001))
+         && to_linear_ticks(at(1000)) < to_linear_ticks(v.stop));
+  assert( hits.size() == ref );
+  interval_tree<seconds> empty_tree {wa.data(), 0};
+  hits.clear();
+  empty_tree.stab(t0, std::back_inserter(hits));
+  assert( hits.empty() && !empty_tree.size() );
+
+  std::cout<<"All checks for interval sets and trees OK\n";
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_iso.hpp"
+
+using namespace ngpt;
+
+template<typename S>
+  std::from_chars_result
+  iso(const char* str, datetime<S>& t)
+{ return parse_iso8601(str, str + std::strlen(str), t); }
+
+template<typename S>
+  std::from_chars_result
+  rfc(const char* str, datetime<S>& t)
+{ return parse_rfc3339(str, str + std::strlen(str), t); }
+
+int main()
+{
+  std::cout<<"Testing ISO 8601 / RFC 3339 parsing\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  const auto ref = strptime_ymd_hms<milliseconds>("2015-12-30 12:09:30.001");
+  datetime<milliseconds> t;
+
+  // calendar, ordinal and week dates, extended and basic formats
+  const char* same_epoch[] = {
+    "2015-12-30T12:09:30.001",
+    "2015-12-30 12:09:30,001",
+    "20151230T120930.001",
+    "2015-364T12:09:30.001",
+    "2015364T120930.001",
+    "2015-W53-3T12:09:30.001",
+    "2015W533T120930.001",
+    "2015-12-30T12:09:30.001Z",
+    "2015-12-30T14:09:30.001+02:00",
+    "2015-12-30T14:39:30.001+0230",
+    "2015-12-30T09:09:30.001-03",
+    "2015-12-31T01:09:30.001+13:00"
+  };
+  for (const char* str : same_epoch) {
+    auto res = iso(str, t);
+    assert( res.ec == std::errc{} && res.ptr == str + std::strlen(str) );
+    assert( t == ref );
+  }
+
+  // offsets can move the epoch to the previous day
+  datetime<seconds> t1;
+  assert( iso("2016-01-01T01:00:00+02:00", t1).ec == std::errc{} );
+  assert( t1 == strptime_ymd_hms<seconds>("2015-12-31 23:00:00") );
+  // decimal fractions of minutes and hours
+  assert( iso("2015-12-30T12:09.5", t1).ec == std::errc{} );
+  assert( t1 == strptime_ymd_hms<seconds>("2015-12-30 12:09:30") );
+  assert( iso("2015-12-30T12,25", t1).ec == std::errc{} );
+  assert( t1 == strptime_ymd_hms<seconds>("2015-12-30 12:15:00") );
+  // end of day and dates without time
+  assert( iso("2015-12-30T24:00:00", t1).ec == std::errc{} );
+  assert( t1 == strptime_ymd_hms<seconds>("2015-12-31 00:00:00") );
+  assert( iso("2015-W01", t1).ec == std::errc{} );
+  assert( t1 == strptime_ymd_hms<seconds>("2014-12-29 00:00:00") );
+  // trailing characters are not interpreted
+  const char* str = "2015-12-30T12:09:30Z,1.0";
+  assert( iso(str, t1).ptr == str + 20 );
+
+  // errors
+  assert( iso("2015-13-30T12:09:30", t1).ec == std::errc::result_out_of_range );
+  assert( iso("2015-366T12:09:30", t1).ec == std::errc::result_out_of_range );
+  assert( iso("2016-W53-1", t1).ec == std::errc::result_out_of_range );
+  assert( iso("2015-12-30T24:00:01", t1).ec == std::errc::result_out_of_range );
+  assert( iso("2015-12-30T12:09:30+24:00", t1).ec
+       == std::errc::result_out_of_range );
+  assert( iso("2015-1230", t1).ec == std::errc::invalid_argument );
+  assert( iso("15-12-30", t1).ec == std::errc::invalid_argument );
+  assert( t1 == strptime_ymd_hms<seconds>("2015-12-30 12:09:30") ); // unchanged
+
+  // RFC 3339
+  datetime<microseconds> t2;
+  assert( rfc("2015-12-30T12:09:30.000011Z", t2).ec == std::errc{} );
+  assert( t2 == strptime_ymd_hms<microseconds>("2015-12-30 12:09:30.000011") );
+  assert( rfc("2015-12-30t14:09:30.000011+02:00", t2).ec == std::errc{} );
+  assert( t2 == strptime_ymd_hms<microseconds>("2015-12-30 12:09:30.000011") );
+  const char* not_rfc[] = {
+    "2015-12-30T12:09:30", "2015-12-30T12:09Z", "20151230T120930Z",
+    "2015-364T12:09:30Z", "2015-W53-3T12:09:30Z", "2015-12-30T12:09:30+0200",
+    "2015-12-30"
+  };
+  for (const char* s : not_rfc)
+    assert( rfc(s, t2).ec == std::errc::invalid_argument );
+
+  std::cout<<"All checks for ISO 8601 / RFC 3339 parsing OK\n";
+  return 0;
+}
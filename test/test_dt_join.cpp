@@ -0,0 +1,93 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_join.hpp"
+
+using namespace ngpt;
+
+/// Brute-force join (nested loops over delta_sec), for reference.
+static std::vector<join_pair>
+brute_join(const std::vector<datetime<seconds>>& a,
+  const std::vector<datetime<milliseconds>>& b, long tol, join_policy p)
+{
+  std::vector<join_pair> pairs;
+  for (std::size_t i = 0; i < a.size(); i++) {
+    std::size_t best = b.size();
+    long bestd = 0L;
+    for (std::size_t j = 0; j < b.size(); j++) {
+      const long d = std::labs(delta_sec(a[i], b[j]).as_underlying_type());
+      if (d > tol) continue;
+      if (p == join_policy::all) {
+        pairs.push_back({i, j});
+      } else if (best == b.size() || (p == join_policy::nearest && d < bestd)) {
+        best = j;
+        bestd = d;
+      }
+    }
+    if (p != join_policy::all && best < b.size()) pairs.push_back({i, best});
+  }
+  return pairs;
+}
+
+int main()
+{
+  std::cout<<"Testing merge-join of epoch arrays\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  // 30 s epochs against jittered 1 s (and some missing) epochs
+  auto t0 = strptime_ymd_hms<seconds>("2015-12-30 23:59:00");
+  std::vector<datetime<seconds>> a;
+  for (int i = 0; i < 200; i++) {
+    a.push_back(t0);
+    t0.add_seconds(seconds{(i % 9) ? 30L : 31L});
+  }
+  auto t1 = strptime_ymd_hms<milliseconds>("2015-12-30 23:58:55");
+  std::vector<datetime<milliseconds>> b;
+  std::uint32_t seed = 4321u;
+  for (int i = 0; i < 7000; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    auto t = t1;
+    t.add_seconds(milliseconds{static_cast<long>((seed >> 16) % 101) - 50L});
+    if ((seed >> 8) % 7) b.push_back(t);
+    t1.add_seconds(milliseconds{1000L});
+  }
+
+  for (long tol : {0L, 20L, 50L, 700L, 2500L}) {
+    for (auto p : {join_policy::nearest, join_policy::first, join_policy::all}) {
+      std::vector<join_pair> pairs;
+      merge_join(a.data(), a.size(), b.data(), b.size(), milliseconds{tol}, p,
+        std::back_inserter(pairs));
+      const auto ref = brute_join(a, b, tol, p);
+      assert( pairs.size() == ref.size() );
+      for (std::size_t i = 0; i < ref.size(); i++)
+        assert( pairs[i].left == ref[i].left && pairs[i].right == ref[i].right );
+    }
+  }
+
+  // empty inputs
+  std::vector<join_pair> pairs;
+  merge_join(a.data(), a.size(), b.data(), 0, milliseconds{50L},
+    join_policy::all, std::back_inserter(pairs));
+  assert( pairs.empty() );
+
+  // unsorted input is rejected
+  std::swap(b[10], b[11]);
+  bool thrown = false;
+  try {
+    merge_join(a.data(), a.size(), b.data(), b.size(), milliseconds{50L},
+      join_policy::nearest, std::back_inserter(pairs));
+  } catch (std::invalid_argument&) {
+    thrown = true;
+  }
+  assert( thrown );
+
+  std::cout<<"All checks for merge-join of epoch arrays OK\n";
+  return 0;
+}
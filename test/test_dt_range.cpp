@@ -0,0 +1,92 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#if __cplusplus >= 202002L
+#include <ranges>
+#endif
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_range.hpp"
+
+using namespace ngpt;
+
+typedef epoch_range<milliseconds> range_t;
+
+#if __cplusplus >= 202002L
+static_assert( std::ranges::random_access_range<range_t> );
+static_assert( std::ranges::sized_range<range_t> );
+#endif
+
+int main()
+{
+  std::cout<<"Testing epoch ranges\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  auto start = strptime_ymd_hms<milliseconds>("2015-12-31 23:58:00");
+  auto stop  = strptime_ymd_hms<milliseconds>("2016-01-01 00:02:00");
+  range_t r {start, stop, milliseconds{30000L}};
+  assert( r.size() == 8 && !r.empty() );
+  assert( r.front() == start );
+  assert( r[4] == strptime_ymd_hms<milliseconds>("2016-01-01 00:00:00") );
+  assert( r.back() == strptime_ymd_hms<milliseconds>("2016-01-01 00:01:30") );
+
+  // the elements match repeated add_seconds
+  auto t = start;
+  std::size_t n = 0;
+  for (const auto& e : r) {
+    assert( e == t );
+    t.add_seconds(milliseconds{30000L});
+    ++n;
+  }
+  assert( n == r.size() );
+
+  // stop is exclusive, partial steps are included
+  assert( (range_t{start, r[4], milliseconds{30000L}}.size()) == 4 );
+  auto s2 = r[4];
+  s2.add_seconds(milliseconds{1L});
+  assert( (range_t{start, s2, milliseconds{30000L}}.size()) == 5 );
+  assert( (range_t{stop, start, milliseconds{30000L}}.empty()) );
+  assert( (range_t{start, milliseconds{1000L}, 86401}.back())
+       == strptime_ymd_hms<milliseconds>("2016-01-01 23:58:00") );
+
+  // random-access iterators
+  auto it = r.begin();
+  assert( it[3] == r[3] && *(it + 5) == r[5] && *(r.end() - 1) == r.back() );
+  assert( r.end() - r.begin() == 8 );
+  it += 6;
+  --it;
+  assert( *it == r[5] && it > r.begin() && it - 5 == r.begin() );
+  assert( std::lower_bound(r.begin(), r.end(), r[6]) - r.begin() == 6 );
+  std::vector<datetime<milliseconds>> v (r.begin(), r.end());
+  assert( v.size() == 8 && v[7] == r.back() );
+  std::reverse_iterator<range_t::iterator> rit {r.end()};
+  assert( *rit == r.back() );
+
+  // slicing and partitioning
+  auto sl = r.slice(2, 5);
+  assert( sl.size() == 3 && sl.front() == r[2] && sl.back() == r[4] );
+  assert( r.slice(6, 100).size() == 2 && r.slice(9, 100).empty() );
+  std::size_t covered = 0;
+  for (std::size_t i = 0; i < 3; i++) {
+    auto p = r.partition(i, 3);
+    assert( p.size() == (i < 2 ? 3u : 2u) );
+    assert( p.front() == r[covered] );
+    covered += p.size();
+  }
+  assert( covered == r.size() );
+
+  bool thrown = false;
+  try {
+    range_t bad {start, stop, milliseconds{0L}};
+  } catch (std::invalid_argument&) {
+    thrown = true;
+  }
+  assert( thrown );
+
+  std::cout<<"All checks for epoch ranges OK\n";
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_rinex.hpp"
+#include "datetime_bulk_write.hpp"
+
+using namespace ngpt;
+
+template<typename S>
+  std::string
+  epoch(const datetime<S>& t, gnss_epoch f)
+{
+  char buf[64];
+  auto res = to_chars_gnss_epoch(buf, buf + sizeof buf, t, f);
+  assert( res.ec == std::errc{} );
+  assert( res.ptr - buf == dtchars::gnss_epoch_chars(f) );
+  return std::string(buf, res.ptr);
+}
+
+int main()
+{
+  std::cout<<"Testing GNSS product file epoch writers\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  // fractional seconds are never rounded up
+  const auto t1 = strptime_ymd_hms<microseconds>("2015-12-30 02:09:59.999996");
+  assert( epoch(t1, gnss_epoch::rinex2_obs) == " 15 12 30  2  9 59.9999960" );
+  assert( epoch(t1, gnss_epoch::rinex3_obs) == "> 2015 12 30 02 09 59.9999960" );
+  assert( epoch(t1, gnss_epoch::sp3) == "*  2015 12 30  2  9 59.99999600" );
+  assert( epoch(t1, gnss_epoch::rinex_clk) == "2015 12 30  2  9 59.999996" );
+
+  const auto t2 = strptime_ymd_hms<seconds>("2006-03-04 13:10:06");
+  assert( epoch(t2, gnss_epoch::rinex2_obs) == " 06  3  4 13 10  6.0000000" );
+  assert( epoch(t2, gnss_epoch::rinex3_obs) == "> 2006 03 04 13 10  6.0000000" );
+  assert( epoch(t2, gnss_epoch::sp3) == "*  2006  3  4 13 10  6.00000000" );
+  assert( epoch(t2, gnss_epoch::rinex_clk) == "2006  3  4 13 10  6.000000" );
+
+  char buf[32];
+  assert( to_chars_gnss_epoch(buf, buf + 30, t1, gnss_epoch::sp3).ec
+       == std::errc::value_too_large );
+
+  // bulk mode
+  std::FILE* fp = std::tmpfile();
+  assert( fp );
+  datetime<microseconds> epochs[] = {t1, t1};
+  epochs[1].add_seconds(microseconds{4L});
+  {
+    epoch_writer<microseconds> w {fileno(fp), gnss_epoch::rinex3_obs};
+    w.write(epochs, epochs + 2);
+  }
+  std::rewind(fp);
+  char line[64];
+  assert( std::fgets(line, sizeof line, fp)
+       && !std::strcmp(line, "> 2015 12 30 02 09 59.9999960\n") );
+  assert( std::fgets(line, sizeof line, fp)
+       && !std::strcmp(line, "> 2015 12 30 02 10  0.0000000\n") );
+  std::fclose(fp);
+
+  std::cout<<"All checks for GNSS epoch writers OK\n";
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <cassert>
+#include <thread>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_ring.hpp"
+
+using namespace ngpt;
+
+typedef datetime<seconds> dt;
+
+int main()
+{
+  std::cout<<"Testing epoch ring buffers and queues\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  auto t0 = strptime_ymd_hms<seconds>("2016-12-31 23:59:50");
+  auto at = [&](long s) { dt t {t0}; t.add_seconds(seconds{s}); return t; };
+
+  // sliding window
+  epoch_ring<seconds, int> ring {8};
+  assert( ring.empty() && ring.capacity() == 8 );
+  for (int i = 0; i < 6; i++) assert( ring.push(at(i * 5), i) );
+  assert( !ring.push(at(20), -1) );            // not monotone
+  assert( ring.push(at(25), 5) );              // equal epochs are fine
+  assert( ring.size() == 7 );
+  assert( ring.evict_older_than(seconds{10L}) == 4 );
+  assert( ring.size() == 3 && ring.epoch(0) == at(20) && ring[0] == 4 );
+  assert( ring.evict_before(at(25)) == 1 && ring.size() == 2 );
+
+  // wrap-around and overwrite of the oldest pairs when full
+  for (int i = 6; i < 20; i++) assert( ring.push(at(i * 5), i) );
+  assert( ring.full() && ring.epoch(0) == at(60) && ring[0] == 12 );
+  assert( ring.epoch(7) == at(95) && ring[7] == 19 );
+  for (std::size_t i = 0; i < ring.size(); i++)
+    assert( ring[i] == 12 + static_cast<int>(i) );
+
+  // binary search inside the window
+  assert( ring.lower_bound(at(0)) == 0 );
+  assert( ring.lower_bound(at(61)) == 1 );
+  assert( ring.lower_bound(at(95)) == 7 );
+  assert( ring.lower_bound(at(96)) == 8 );
+  ring.pop_front(3);
+  assert( ring.size() == 5 && ring.lower_bound(at(80)) == 1 );
+  ring.clear();
+  assert( ring.empty() && ring.evict_older_than(seconds{1L}) == 0 );
+
+  bool thrown = false;
+  try { epoch_ring<seconds, int> r0 {0}; } catch (std::invalid_argument&) {
+    thrown = true; }
+  assert( thrown );
+
+  // single-producer / single-consumer hand-over
+  spsc_epoch_queue<seconds, long> queue {1000};
+  assert( queue.capacity() == 1024 && !queue.size() );
+  const long N = 100000L;
+  std::thread producer([&]() {
+    for (long i = 0; i < N; i++)
+      while (!queue.try_push(at(i), i)) std::this_thread::yield();
+  });
+  long expected = 0;
+  dt t;
+  long v;
+  while (expected < N) {
+    if (queue.try_pop(t, v)) {
+      assert( v == expected && t == at(expected) );
+      ++expected;
+    }
+  }
+  producer.join();
+  assert( !queue.try_pop(t, v) );
+
+  std::cout<<"All checks for epoch ring buffers and queues OK\n";
+  return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_series.hpp"
+
+using namespace ngpt;
+
+typedef datetime<milliseconds> dt;
+
+/// A cubic in seconds from the start of the series, and its rate.
+double f(double s)  { return 1e3 + 2e-1 * s - 3e-5 * s * s + 4e-9 * s * s * s; }
+double df(double s) { return 2e-1 - 6e-5 * s + 12e-9 * s * s; }
+/// A quadratic.
+double g(double s)  { return 1e3 + 2e-1 * s - 3e-5 * s * s; }
+
+int main()
+{
+  std::cout<<"Testing time series\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  auto t0 = strptime_ymd_hms<milliseconds>("2016-12-31 22:00:00.000");
+  auto at = [&](double s) { dt t {t0};
+    t.add_seconds(milliseconds{std::lround(s * 1e3)}); return t; };
+
+  // 15-minute (SP3-like) series of a cubic, with and without rates
+  time_series<milliseconds, double> ts, tr;
+  for (int i = 0; i <= 16; i++) {
+    ts.push_back(at(i * 900.), f(i * 900.));
+    tr.push_back(at(i * 900.), f(i * 900.), df(i * 900.));
+  }
+  assert( ts.size() == 17 && ts.epoch(4) == at(3600.) );
+
+  // Lagrange and Hermite (with rates) reproduce a cubic; Hermite with
+  // (central) finite-difference rates reproduces a quadratic, away from the
+  // ends; linear is exact at the nodes
+  time_series<milliseconds, double> tq;
+  for (int i = 0; i <= 16; i++) tq.push_back(at(i * 900.), g(i * 900.));
+  time_series<milliseconds, double>::cursor c;
+  for (double s = 0.; s <= 16 * 900.; s += 37.5) {
+    assert( std::abs(ts.interpolate(at(s), interp_method::lagrange, c)
+      - f(s)) < 1e-9 );
+    assert( std::abs(ts.interpolate(at(s), interp_method::lagrange, 4)
+      - f(s)) < 1e-9 );
+    assert( std::abs(tr.interpolate(at(s), interp_method::hermite) - f(s))
+      < 1e-9 );
+    if (s >= 900. && s <= 15 * 900.)
+      assert( std::abs(tq.interpolate(at(s), interp_method::hermite) - g(s))
+        < 1e-9 );
+  }
+  assert( c.index == 15 );
+  for (int i = 0; i <= 16; i++)
+    assert( std::abs(ts.interpolate(at(i * 900.), interp_method::linear)
+      - f(i * 900.)) < 1e-12 );
+  assert( std::abs(ts.interpolate(at(450.), interp_method::linear)
+    - (f(0.) + f(900.)) / 2) < 1e-12 );
+
+  // random-order queries through the same cursor
+  c.index = 3;
+  assert( std::abs(ts.interpolate(at(14000.), interp_method::lagrange, c)
+    - f(14000.)) < 1e-9 && c.index == 15 );
+  assert( std::abs(ts.interpolate(at(100.), interp_method::lagrange, c)
+    - f(100.)) < 1e-9 && c.index == 0 );
+
+  // queries alternating over two series keep a cursor per series
+  for (std::size_t i = 0; i < 16; i++) {
+    ts.interpolate(at(i * 900. + 450.), interp_method::linear);
+    tq.interpolate(at(i * 900. + 450.), interp_method::linear);
+    assert( ts.thread_cursor().index == i && tq.thread_cursor().index == i );
+  }
+
+  // batch queries match single ones
+  std::vector<dt> q;
+  for (double s = 10.; s < 14000.; s += 333.3) q.push_back(at(s));
+  std::vector<double> out(q.size());
+  ts.interpolate(q.data(), q.size(), interp_method::lagrange, out.data(), 8);
+  for (std::size_t i = 0; i < q.size(); i++)
+    assert( out[i] == ts.interpolate(q[i], interp_method::lagrange, c, 8) );
+
+  // errors
+  bool thrown = false;
+  try { ts.interpolate(at(-1.), interp_method::linear); }
+  catch (std::out_of_range&) { thrown = true; }
+  assert( thrown );
+  thrown = false;
+  try { ts.push_back(at(0.), 0.); }
+  catch (std::invalid_argument&) { thrown = true; }
+  assert( thrown );
+  thrown = false;
+  try { tr.push_back(at(1e5), 0.); }
+  catch (std::invalid_argument&) { thrown = true; }
+  assert( thrown );
+
+  std::cout<<"All checks for time series OK\n";
+  return 0;
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_sniff.hpp"
+
+using namespace ngpt;
+
+template<typename S>
+  std::from_chars_result
+  parse(const epoch_parser<S>& p, const char* str, datetime<S>& t)
+{ return p.parse(str, str + std::strlen(str), t); }
+
+int main()
+{
+  std::cout<<"Testing epoch layout auto-detection\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  // year, month, day of month with data columns following the epoch
+  const char* ymd_lines[] = {
+    "2015-12-30 12:09:30.000011   1.2345  2.3456",
+    "2015-12-30 12:09:31.000011   1.2345  2.3456",
+    "2016-01-01 00:00:00.500000  -1.2345  2.3456"
+  };
+  auto p1 = sniff_epoch_parser<microseconds>(ymd_lines, 3);
+  assert( p1.info().layout == epoch_layout::ymd );
+  assert( p1.info().fraction_digits == 6 );
+  assert( p1.fixed_columns() );
+  datetime<microseconds> d1, d2;
+  auto res = parse(p1, ymd_lines[0], d1);
+  assert( res.ec == std::errc{} && *res.ptr == ' ' );
+  assert( d1 == strptime_ymd_hms<microseconds>(ymd_lines[0]) );
+  // a line not conforming to the fixed columns falls back to the generic path
+  assert( parse(p1, "2015-12-30 12:9:30.000011", d2).ec == std::errc{} );
+  assert( d1 == d2 );
+  assert( parse(p1, "2015-13-30 12:09:30.000011", d2).ec
+        == std::errc::result_out_of_range );
+  // so does a line with a wrong separator at the fixed columns (and fails)
+  assert( parse(p1, "2015x12-30 12:09:30.000011", d2).ec
+        == std::errc::invalid_argument );
+  assert( parse(p1, "2015-12-30 12:09-30.000011", d2).ec
+        == std::errc::invalid_argument );
+
+  // year, day of year; variable columns
+  const char* ydoy_lines[] = {
+    "2015/364 12:09:30.5",
+    "2015/364  2:09:30.25"
+  };
+  auto p2 = sniff_epoch_parser<milliseconds>(ydoy_lines, 2);
+  assert( p2.info().layout == epoch_layout::ydoy );
+  assert( p2.info().fraction_digits == 2 && !p2.fixed_columns() );
+  datetime<milliseconds> d3, d4;
+  assert( parse(p2, ydoy_lines[0], d3).ec == std::errc{} );
+  assert( d3 == strptime_ydoy_hms<milliseconds>(ydoy_lines[0]) );
+
+  // year, month name, day of month
+  const char* yod_lines[] = {"2015 Dec 30 12 09 30.001 G01"};
+  auto p3 = sniff_epoch_parser<milliseconds>(yod_lines, 1);
+  assert( p3.info().layout == epoch_layout::yod );
+  assert( parse(p3, yod_lines[0], d4).ec == std::errc{} );
+  d4.add_seconds(milliseconds{499});
+  assert( d4 == d3 );
+
+  // ISO-like, with a trailing 'Z'
+  const char* iso_lines[] = {"2015-12-30T12:09:30Z", "2015-12-31T00:00:00Z"};
+  auto p4 = sniff_epoch_parser<seconds>(iso_lines, 2);
+  assert( p4.info().layout == epoch_layout::iso && p4.info().zulu );
+  datetime<seconds> d5;
+  res = parse(p4, iso_lines[0], d5);
+  assert( res.ec == std::errc{} && *res.ptr == '\0' );
+  assert( d5 == strptime_ymd_hms<seconds>("2015-12-30 12:09:30") );
+  assert( parse(p4, "2015-12-30T12:09:30X", d5).ec != std::errc{} );
+
+  // only a date
+  const char* date_lines[] = {"2015-12-30 obs", "2015-12-31 obs"};
+  auto p5 = sniff_epoch_parser<seconds>(date_lines, 2);
+  assert( p5.info().time_fields == 0 );
+  assert( parse(p5, date_lines[1], d5).ec == std::errc{} );
+  assert( d5.mjd() == modified_julian_day{57387} );
+
+  // inconsistent or unrecognizable lines throw
+  const char* bad_lines[] = {"2015-12-30 12:09:30", "2015/364 12:09:30"};
+  bool thrown = false;
+  try {
+    sniff_epoch_parser<seconds>(bad_lines, 2);
+  } catch (std::invalid_argument&) {
+    thrown = true;
+  }
+  assert( thrown );
+  thrown = false;
+  try {
+    sniff_epoch_parser<seconds>(bad_lines+1, 0);
+  } catch (std::invalid_argument&) {
+    thrown = true;
+  }
+  assert( thrown );
+
+  std::cout<<"All checks for epoch layout sniffing OK\n";
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <cassert>
+#include <sstream>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_stream.hpp"
+
+using namespace ngpt;
+
+int main()
+{
+  std::cout<<"Testing stream operators\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  auto t = strptime_ymd_hms<microseconds>("2015-12-30 02:09:59.999996");
+
+  // writing, in all layouts
+  std::ostringstream os;
+  os << t;
+  assert( os.str() == "2015-12-30 02:09:59.999996" );
+  os.str("");
+  os << epoch_io(epoch_layout::ydoy, 3) << t << '|' << t;
+  assert( os.str() == "2015-364 02:09:59.999|2015-364 02:09:59.999" );
+  os.str("");
+  os << epoch_io(epoch_layout::yod, 0) << t;
+  assert( os.str() == "2015 Dec 30 02:09:59" );
+  os.str("");
+  os << epoch_io(epoch_layout::iso) << t;
+  assert( os.str() == "2015-12-30T02:09:59.999996" );
+  os.str("");
+  os << epoch_io(epoch_layout::ymd, 0);
+  os.width(22);
+  os << t << '|';
+  os.width(21);
+  os << std::left << t << '|';
+  assert( os.str() == "   2015-12-30 02:09:59|2015-12-30 02:09:59  |" );
+
+  // intervals
+  datetime_interval<milliseconds> d {modified_julian_day{3},
+                                     milliseconds{3723500L}};
+  os.str("");
+  os << d;
+  assert( os.str() == "3d 01:02:03.500" );
+
+  // reading
+  std::istringstream is {"2015-12-30 02:09:59.999996\n"
+                         "  2015-12-30 02:09:59  2015-364 02:09:59.5\n"
+                         "2015 Dec 30 02:09:59.999996"};
+  datetime<microseconds> r;
+  is >> r;
+  assert( is && r == t );
+  is >> r;
+  assert( is && r == strptime_ymd_hms<microseconds>("2015-12-30 02:09:59") );
+  is >> epoch_io(epoch_layout::ydoy) >> r;
+  assert( is && r == strptime_ymd_hms<microseconds>("2015-12-30 02:09:59.5") );
+  is >> epoch_io(epoch_layout::yod) >> r;
+  assert( r == t && is.eof() && !is.fail() );
+
+  // round trips, including the iso layout
+  for (auto l : {epoch_layout::ymd, epoch_layout::ydoy, epoch_layout::yod,
+                 epoch_layout::iso}) {
+    std::stringstream ss;
+    ss << epoch_io(l) << t << ' ' << t;
+    datetime<microseconds> r1, r2;
+    ss >> epoch_io(l) >> r1 >> r2;
+    assert( !ss.fail() && r1 == t && r2 == t );
+  }
+  std::istringstream isd {"3d 01:02:03.5"};
+  datetime_interval<milliseconds> rd;
+  isd >> rd;
+  assert( !isd.fail() && rd.days() == d.days() && rd.sec() == d.sec() );
+  // negative intervals, in sign-magnitude form
+  std::stringstream ssn;
+  ssn << datetime_interval<milliseconds>{} - d;
+  assert( ssn.str() == "-3d 01:02:03.500" );
+  ssn >> rd;
+  assert( !ssn.fail() && rd.sign() < 0
+       && rd + d == datetime_interval<milliseconds>{} );
+
+  // failures leave the datetime unchanged
+  std::istringstream bad {"2015-13-30 02:09:59"};
+  r = t;
+  bad >> r;
+  assert( bad.fail() && r == t );
+  std::istringstream bad2 {"2015-12-30"};
+  bad2 >> r;
+  assert( bad2.fail() && r == t );
+  std::istringstream bad3 {"2015-12-30 02:09:59x"};
+  bad3 >> r;
+  assert( bad3.fail() && r == t );
+
+  std::cout<<"All checks for stream operators OK\n";
+  return 0;
+}
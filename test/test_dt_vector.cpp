@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_vector.hpp"
+#include "datetime_batch.hpp"
+#include "datetime_bulk_write.hpp"
+
+using namespace ngpt;
+
+typedef datetime<milliseconds> dt;
+
+int main()
+{
+  std::cout<<"Testing structure-of-arrays datetime vector\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  // AoS to SoA and back
+  std::vector<dt> aos;
+  auto t = strptime_ymd_hms<milliseconds>("2016-12-31 23:59:40");
+  for (int i = 0; i < 100; i++) {
+    aos.push_back(t);
+    t.add_seconds(milliseconds{1250L});
+  }
+  datetime_vector<milliseconds> v {aos.data(), aos.size()};
+  assert( v.size() == aos.size() && !v.empty() );
+  assert( reinterpret_cast<std::uintptr_t>(v.mjd_data()) % 64 == 0 );
+  assert( reinterpret_cast<std::uintptr_t>(v.sec_data()) % 64 == 0 );
+  assert( v.to_aos() == aos );
+  const datetime_vector<milliseconds>& cv = v;
+  for (std::size_t i = 0; i < aos.size(); i++) {
+    assert( cv[i] == aos[i] );
+    assert( v.mjd_data()[i] == aos[i].mjd().as_underlying_type() );
+  }
+
+  // proxy references
+  datetime_vector<milliseconds>& rv = v;
+  rv[0] = aos[50];
+  assert( static_cast<dt>(rv[0]) == aos[50] && rv[0].sec() == aos[50].sec() );
+  rv[1] = rv[2];
+  assert( static_cast<dt>(rv[1]) == aos[2] );
+  rv[0] = aos[0];
+  rv[1] = aos[1];
+  v.push_back(t);
+  assert( v.size() == 101 && cv[100] == t );
+  v.resize(100);
+
+  // kernels: differences, calendar and leap seconds
+  datetime_vector<milliseconds> w {aos.data(), aos.size()};
+  snap_to_grid(w, milliseconds{5000L}, snap_mode::floor, w);
+  std::vector<dt> snapped(aos.size());
+  snap_to_grid(aos.data(), aos.size(), milliseconds{5000L}, snap_mode::floor,
+    snapped.data());
+  assert( w.to_aos() == snapped );
+  snap_to_grid(v, milliseconds{7000L}, snap_mode::nearest, w);
+  snap_to_grid(aos.data(), aos.size(), milliseconds{7000L}, snap_mode::nearest,
+    snapped.data());
+  assert( w.to_aos() == snapped );
+
+  std::vector<long> d(v.size());
+  delta_sec(v, w, d.data());
+  for (std::size_t i = 0; i < v.size(); i++)
+    assert( d[i] == delta_sec(aos[i], snapped[i]).as_underlying_type() );
+
+  std::vector<std::size_t> idx(v.size()), idx2(v.size());
+  const std::size_t k = decimate(v, milliseconds{5000L}, milliseconds{0L},
+    idx.data());
+  assert( k == decimate(aos.data(), aos.size(), milliseconds{5000L},
+    milliseconds{0L}, idx2.data()) );
+  assert( k == 25 && std::equal(idx.begin(), idx.begin() + k, idx2.begin()) );
+
+  std::vector<ymd_date> ymd(v.size());
+  to_ymd(v, ymd.data());
+  std::vector<int> leap(v.size());
+  dat(v, leap.data());
+  for (std::size_t i = 0; i < v.size(); i++) {
+    assert( ymd[i].__year == aos[i].as_ymd().__year );
+    assert( ymd[i].__dom == aos[i].as_ymd().__dom );
+    assert( leap[i] == dat(aos[i]) );
+  }
+  assert( leap.front() == 36 && leap.back() == 37 );
+
+  // formatting
+  int fds[2];
+  assert( !pipe(fds) );
+  {
+    epoch_writer<milliseconds> wr {fds[1], epoch_layout::ymd, '-', 3};
+    datetime_vector<milliseconds> few {aos.data(), 3};
+    wr.write(few);
+  }
+  close(fds[1]);
+  char buf[256];
+  const ssize_t n = read(fds[0], buf, sizeof buf);
+  close(fds[0]);
+  assert( std::string(buf, n) == "2016-12-31 23:59:40.000\n"
+                                 "2016-12-31 23:59:41.250\n"
+                                 "2016-12-31 23:59:42.500\n" );
+
+  std::cout<<"All checks for structure-of-arrays datetime vector OK\n";
+  return 0;
+}
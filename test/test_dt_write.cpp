@@ -0,0 +1,73 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_write.hpp"
+
+using namespace ngpt;
+
+char buf[64];
+
+// null-terminate the result of a write
+void
+nul_terminate(std::to_chars_result r)
+{
+  assert( r.ec == std::errc{} );
+  *r.ptr = '\0';
+}
+
+int main()
+{
+  std::cout<<"Testing allocation-free datetime formatters\n";
+  std::cout<<"-------------------------------------------------------------\n";
+
+  const auto t1 = strptime_ymd_hms<microseconds>("2015-12-30 02:09:03.000011");
+
+  nul_terminate(to_chars_ymd_hms(buf, buf+64, t1));
+  assert( !std::strcmp(buf, "2015-12-30 02:09:03") );
+  nul_terminate(to_chars_ymd_hms(buf, buf+64, t1, '/', 6));
+  assert( !std::strcmp(buf, "2015/12/30 02:09:03.000011") );
+  // fewer digits truncate, more digits are zero-padded
+  nul_terminate(to_chars_ymd_hms(buf, buf+64, t1, '-', 5));
+  assert( !std::strcmp(buf, "2015-12-30 02:09:03.00001") );
+  nul_terminate(to_chars_ymd_hms(buf, buf+64, t1, '-', 9));
+  assert( !std::strcmp(buf, "2015-12-30 02:09:03.000011000") );
+  nul_terminate(to_chars_ydoy_hms(buf, buf+64, t1, '-', 3));
+  assert( !std::strcmp(buf, "2015-364 02:09:03.000") );
+  nul_terminate(to_chars_yod_hms(buf, buf+64, t1, ' ', 6));
+  assert( !std::strcmp(buf, "2015 Dec 30 02:09:03.000011") );
+
+  // round trips through the (old) readers
+  const auto t2 = strptime_ymd_hms<milliseconds>("2016-01-01 23:59:59.999");
+  nul_terminate(to_chars_ymd_hms(buf, buf+64, t2, '-', 3));
+  assert( strptime_ymd_hms<milliseconds>(buf) == t2 );
+  nul_terminate(to_chars_ydoy_hms(buf, buf+64, t2, '-', 3));
+  assert( strptime_ydoy_hms<milliseconds>(buf) == t2 );
+  nul_terminate(to_chars_yod_hms(buf, buf+64, t2, '-', 3));
+  assert( strptime_yod_hms<milliseconds>(buf) == t2 );
+
+  // errors
+  assert( to_chars_ymd_hms(buf, buf + 18, t1).ec == std::errc::value_too_large );
+  assert( to_chars_ymd_hms(buf, buf + 19, t1).ec == std::errc{} );
+  assert( to_chars_ymd_hms(buf, buf + 64, t1, '-', 10).ec
+       == std::errc::invalid_argument );
+
+  // string wrappers
+  assert( strftime_ymd_hms(t1) == "2015-12-30 02:09:03" );
+  assert( strftime_ymd_hmfs(t1) == "2015-12-30 02:09:03.00001" );
+  assert( t2.stringify() == "2016/01/01 23:59:59.999000000" );
+
+  // negative (and wide) years are written with a sign and their magnitude
+  const datetime<seconds> t3 {modified_julian_day{-700000L}, seconds{0L}};
+  assert( strftime_ymd_hms(t3) == "-0058-05-06 00:00:00" );
+  assert( t3.stringify() == "-0058/05/06 00:00:00.000000000" );
+  assert( to_chars_ydoy_hms(buf, buf + 17, t3).ec == std::errc::value_too_large );
+  const datetime<seconds> t4 {modified_julian_day{4000000L}, seconds{0L}};
+  assert( strftime_ymd_hms(t4).substr(0, 6) == "12810-" );
+
+  std::cout<<"All checks for datetime formatters OK\n";
+  return 0;
+}
@@ -72,6 +72,64 @@ int main()
   assert( (s = 2020) == s2 );
   std::cout<<"\n\tAll tests for milliseconds OK!";
 
+  std::cout<<"\n>Testing arithmetic on datetime_interval";
+  using ngpt::modified_julian_day;
+  typedef ngpt::datetime_interval<ngpt::microseconds> ivus;
+  constexpr long usd = ngpt::microseconds::max_in_day;
+  // ~30 years in microseconds; exact where doubles are not
+  constexpr ivus a {modified_julian_day{10957L}, ngpt::microseconds{1L}};
+  constexpr ivus b {modified_julian_day{1L}, ngpt::microseconds{usd / 2}};
+  static_assert( (a + b).days().as_underlying_type() == 10958L );
+  static_assert( (a + b).sec().as_underlying_type() == usd / 2 + 1L );
+  static_assert( (a - b).days().as_underlying_type() == 10955L );
+  static_assert( (a - b).sec().as_underlying_type() == usd / 2 + 1L );
+  static_assert( (b * 4) == ivus{modified_julian_day{6L},
+                                 ngpt::microseconds{0L}} );
+  static_assert( (3 * b) == b + b + b );
+  static_assert( (a / 3) * 3 + ivus{modified_julian_day{0L},
+    ngpt::microseconds{static_cast<long>(a.ticks() % 3)}} == a );
+  constexpr auto q = ngpt::div(a, 7L);
+  static_assert( q.quot * 7 + ivus{modified_julian_day{0L}, q.rem} == a );
+  static_assert( a / b == 7304L );
+  static_assert( a % b == a - b * 7304 );
+  // the old implementation (via std::modf) got this wrong
+  static_assert( (ivus{modified_julian_day{10957L}, ngpt::microseconds{3L}}
+    / 2).sec().as_underlying_type() == usd / 2 + 1L );
+  // negative differences are in floor form; abs
+  static_assert( (b - a).days().as_underlying_type() == -10956L );
+  static_assert( ngpt::abs(b - a) == a - b );
+  // comparison with second types
+  static_assert( b == ngpt::milliseconds{usd / 1000L * 3L / 2L} );
+  static_assert( b > ngpt::seconds{129599L} && b < ngpt::seconds{129601L} );
+  static_assert( b >= ngpt::seconds{129600L} && b <= ngpt::seconds{129600L} );
+  static_assert( b != ngpt::microseconds{usd * 3L / 2L + 1L} );
+  static_assert( b.compare(ngpt::microseconds{usd * 3L / 2L + 1L}) < 0 );
+  // signed intervals (floor form) and conversions to/from delta_sec
+  static_assert( ivus{modified_julian_day{0L}, ngpt::microseconds{-1L}}.days()
+    .as_underlying_type() == -1L );
+  static_assert( ivus{modified_julian_day{0L}, ngpt::microseconds{-1L}}.sec()
+    .as_underlying_type() == usd - 1L );
+  static_assert( ivus{ngpt::microseconds{-usd - 5L}}
+    == ivus{modified_julian_day{-2L}, ngpt::microseconds{usd - 5L}} );
+  static_assert( ivus{ngpt::microseconds{-usd - 5L}}.to_sec()
+    == ngpt::microseconds{-usd - 5L} );
+  static_assert( (b - a).sign() == -1 && (a - b).sign() == 1
+    && (a - a).sign() == 0 );
+  static_assert( ivus{ngpt::microseconds{1L}}.sign() == 1 );
+  static_assert( ivus{ngpt::microseconds{-1L}}.sign() == -1 );
+  {
+    ngpt::datetime<ngpt::microseconds> t1 {modified_julian_day{58000L},
+      ngpt::microseconds{10L}};
+    ngpt::datetime<ngpt::microseconds> t2 {modified_julian_day{58001L},
+      ngpt::microseconds{5L}};
+    auto d12 = t1.delta_date(t2);
+    assert( d12.sign() < 0 && d12 == ngpt::datetime_interval<
+      ngpt::microseconds>{ngpt::delta_sec(t1, t2)} );
+    assert( ngpt::abs(d12) == t2.delta_date(t1) );
+    assert( d12.to_sec() == ngpt::delta_sec(t1, t2) );
+  }
+  std::cout<<"\n\tAll tests for datetime_interval OK!";
+
   std::cout<<"\n";
   return 0;
 }
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <chrono>
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+
+#include "dtfund.hpp"
+#include "dtcalendar.hpp"
+#include "datetime_read.hpp"
+#include "datetime_hash.hpp"
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::time_point;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+
+typedef ngpt::datetime<ngpt::milliseconds> dt;
+
+/// Insert all keys, then look all of them up; report the times in ms.
+template<typename Map>
+  void
+  run(const char* name, Map& map, const std::vector<dt>& keys)
+{
+  time_point<Clock> start = Clock::now();
+  for (std::size_t i = 0; i < keys.size(); i++) map[keys[i]] = i;
+  time_point<Clock> mid = Clock::now();
+  std::size_t sum = 0;
+  for (const auto& k : keys) sum += map[k];
+  time_point<Clock> end = Clock::now();
+  assert( sum == keys.size() * (keys.size() - 1) / 2 );
+  std::cout<<"\n"<<name<<" -> insert: "
+    <<duration_cast<milliseconds>(mid - start).count()<<" lookup: "
+    <<duration_cast<milliseconds>(end - mid).count()<<" ms";
+}
+
+int main()
+{
+  const std::size_t N = 10000000;
+  // 10M epochs at a 1 s rate, with a few (1 in 1000) gaps
+  auto t = ngpt::strptime_ymd_hms<ngpt::milliseconds>(
+    "2015/12/30 00:00:00.000");
+  std::vector<dt> keys;
+  keys.reserve(N);
+  for (std::size_t i = 0; i < N; i++) {
+    t.add_seconds(ngpt::milliseconds{(i % 1000) ? 1000L : 31000L});
+    keys.push_back(t);
+  }
+
+  for (int rep = 0; rep < 3; rep++) {
+    std::unordered_map<dt, std::size_t> umap;
+    run("std::unordered_map", umap, keys);
+    ngpt::epoch_map<ngpt::milliseconds, std::size_t> emap;
+    run("ngpt::epoch_map   ", emap, keys);
+  }
+
+  std::cout<<"\n";
+  return 0;
+}
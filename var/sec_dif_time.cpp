@@ -2,11 +2,13 @@
 #include <chrono>
 #include <cassert>
 #include <limits>
+#include <vector>
 
 #include "dtfund.hpp"
 #include "dtcalendar.hpp"
 #include "datetime_read.hpp"
 #include "datetime_write.hpp"
+#include "datetime_batch.hpp"
 
 using Clock = std::chrono::steady_clock;
 using std::chrono::time_point;
@@ -100,6 +102,22 @@ int main()
   milliseconds diff2_3 = duration_cast<milliseconds>(end2_3 - start2_3);
   std::cout<<"\nResults using instances  -> A:"<<diff2_1.count()<<" B: "<<diff2_2.count()<<" C: "<<diff2_3.count()<<" ms ";
 
+
+  // the same differences, computed by the batch kernel over an array
+  std::vector<ngpt::datetime<ngpt::milliseconds>> epochs;
+  for (ngpt::milliseconds s{1L}; s<MAX; s+=10) {
+    date.add_seconds(s);
+    epochs.push_back(date);
+  }
+  std::vector<double> dsec(epochs.size());
+  time_point<Clock> start3 = Clock::now();
+  for (int i = 0; i < 3; i++)
+    ngpt::delta_sec(epochs.data(), epochs.size(), ref_date, dsec.data());
+  time_point<Clock> end3 = Clock::now();
+  assert( dsec.back() == -delta_sec_1(ref_date, epochs.back()) );
+  milliseconds diff3 = duration_cast<milliseconds>(end3 - start3);
+  std::cout<<"\nResults using batch      -> "<<diff3.count()/3.<<" ms (average of 3)";
+
   std::cout<<"\n";
   return 0;
 }
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <stdexcept>
+#include <string_view>
 #include "dtfund.hpp"
 
 using ngpt::month;
@@ -44,6 +45,23 @@ int main()
     assert( exception_thrown );
   }
 
+  // non-throwing lookup; strings need not be null-terminated
+  const char* long_names[] = {"January", "February", "March", "April", "May",
+    "June", "July", "August", "September", "October", "November", "December"};
+  for (int i=0; i<12; i++) {
+    std::string_view name {long_names[i]};
+    assert( ngpt::month_from_str(name) == i+1 );
+    assert( ngpt::month_from_str(name.substr(0, 3)) == i+1 );
+    assert( month(long_names[i]) == month(i+1) );
+  }
+  assert( ngpt::month_from_str("SEPTEMBER", 9) == 9 );
+  assert( ngpt::month_from_str("decXXX", 3) == 12 );
+  for (int i=0; i<sz; i++)
+    assert( !ngpt::month_from_str(invalid_names[i]) );
+  assert( !ngpt::month_from_str("May ", 4) );
+  assert( !ngpt::month_from_str("Sept", 4) );
+  assert( !ngpt::month_from_str("J@n", 3) );
+
   // testing operators
   assert( mn1 == mn3 );
   assert( mn1 != mn2 );